@@ -119,8 +119,12 @@ void Game::ProcessInput()
 void Game::UpdateGame()
 {
 	// Wait until 16ms has elapsed since last frame
-	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + 16))
-		;
+	// (sleep rather than spin, so waiting doesn't burn a core)
+	Uint32 elapsed = SDL_GetTicks() - mTicksCount;
+	if (elapsed < 16)
+	{
+		SDL_Delay(16 - elapsed);
+	}
 
 	// Delta time is the difference in ticks from last frame
 	// (converted to seconds)
@@ -14,13 +14,25 @@ class CircleComponent : public Component
 {
 public:
 	CircleComponent(class Actor* owner);
+	~CircleComponent();
+
+	// Keeps the hash's cell for this circle up to date
+	void Update(float deltaTime) override;
 	
 	void SetRadius(float radius) { mRadius = radius; }
 	float GetRadius() const;
 	
 	const Vector2& GetCenter() const;
+
+	// Keep this circle in a spatial hash (or nullptr to take it out)
+	void SetSpatialHash(class SpatialHash* hash);
+	// Cell in the spatial hash (set by the hash)
+	int GetHashCell() const { return mHashCell; }
+	void SetHashCell(int cell) { mHashCell = cell; }
 private:
 	float mRadius;
+	class SpatialHash* mHash;
+	int mHashCell;
 };
 
 bool Intersect(const CircleComponent& a, const CircleComponent& b);
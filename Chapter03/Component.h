@@ -23,6 +23,7 @@ public:
 	virtual void ProcessInput(const uint8_t* keyState) {}
 
 	int GetUpdateOrder() const { return mUpdateOrder; }
+	class Actor* GetOwner() { return mOwner; }
 protected:
 	// Owning actor
 	class Actor* mOwner;
@@ -14,12 +14,15 @@
 #include "Ship.h"
 #include "Asteroid.h"
 #include "Random.h"
+#include "SpatialHash.h"
+#include "CircleComponent.h"
 
 Game::Game()
 :mWindow(nullptr)
 ,mRenderer(nullptr)
 ,mIsRunning(true)
 ,mUpdatingActors(false)
+,mAsteroidHash(nullptr)
 {
 	
 }
@@ -102,8 +105,12 @@ void Game::UpdateGame()
 {
 	// Compute delta time
 	// Wait until 16ms has elapsed since last frame
-	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + 16))
-		;
+	// (sleep rather than spin, so waiting doesn't burn a core)
+	Uint32 elapsed = SDL_GetTicks() - mTicksCount;
+	if (elapsed < 16)
+	{
+		SDL_Delay(16 - elapsed);
+	}
 
 	float deltaTime = (SDL_GetTicks() - mTicksCount) / 1000.0f;
 	if (deltaTime > 0.05f)
@@ -160,6 +167,10 @@ void Game::GenerateOutput()
 
 void Game::LoadData()
 {
+	// Same bounds as the screen wrapping in MoveComponent
+	mAsteroidHash = new SpatialHash(Vector2::Zero,
+		Vector2(1024.0f, 768.0f));
+
 	// Create player's ship
 	mShip = new Ship(this);
 	mShip->SetPosition(Vector2(512.0f, 384.0f));
@@ -183,6 +194,8 @@ void Game::UnloadData()
 	{
 		delete mActors.back();
 	}
+	delete mAsteroidHash;
+	mAsteroidHash = nullptr;
 
 	// Destroy textures
 	for (auto i : mTextures)
@@ -228,6 +241,7 @@ SDL_Texture* Game::GetTexture(const std::string& fileName)
 void Game::AddAsteroid(Asteroid* ast)
 {
 	mAsteroids.emplace_back(ast);
+	ast->GetCircle()->SetSpatialHash(mAsteroidHash);
 }
 
 void Game::RemoveAsteroid(Asteroid* ast)
@@ -238,6 +252,7 @@ void Game::RemoveAsteroid(Asteroid* ast)
 	{
 		mAsteroids.erase(iter);
 	}
+	ast->GetCircle()->SetSpatialHash(nullptr);
 }
 
 void Game::Shutdown()
@@ -32,6 +32,8 @@ public:
 	void AddAsteroid(class Asteroid* ast);
 	void RemoveAsteroid(class Asteroid* ast);
 	std::vector<class Asteroid*>& GetAsteroids() { return mAsteroids; }
+	// Asteroids' circles, for finding the ones near a point
+	class SpatialHash* GetAsteroidHash() { return mAsteroidHash; }
 private:
 	void ProcessInput();
 	void UpdateGame();
@@ -60,4 +62,5 @@ private:
 	// Game-specific
 	class Ship* mShip; // Player's ship
 	std::vector<class Asteroid*> mAsteroids;
+	class SpatialHash* mAsteroidHash;
 };
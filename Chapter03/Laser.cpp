@@ -11,7 +11,7 @@
 #include "MoveComponent.h"
 #include "Game.h"
 #include "CircleComponent.h"
-#include "Asteroid.h"
+#include "SpatialHash.h"
 
 Laser::Laser(Game* game)
 	:Actor(game)
@@ -42,17 +42,18 @@ void Laser::UpdateActor(float deltaTime)
 	else
 	{
 		mMove->AddForce(GetForward() * mMove->GetForwardSpeed());
-		// Do we intersect with an asteroid?
-		for (auto ast : GetGame()->GetAsteroids())
-		{
-			if (Intersect(*mCircle, *(ast->GetCircle())))
+		// Do we intersect with an asteroid? (only check nearby ones)
+		GetGame()->GetAsteroidHash()->Query(mCircle->GetCenter(), mCircle->GetRadius(),
+			[this](CircleComponent* circle) {
+			if (Intersect(*mCircle, *circle))
 			{
 				// The first asteroid we intersect with,
 				// set ourselves and the asteroid to dead
 				SetState(EDead);
-				ast->SetState(EDead);
-				break;
+				circle->GetOwner()->SetState(EDead);
+				return false;
 			}
-		}
+			return true;
+		});
 	}
 }
@@ -12,7 +12,7 @@
 #include "Game.h"
 #include "Laser.h"
 #include "CircleComponent.h"
-#include "Asteroid.h"
+#include "SpatialHash.h"
 
 Ship::Ship(Game* game)
 	:Actor(game)
@@ -55,21 +55,22 @@ void Ship::UpdateActor(float deltaTime)
 		this->mElapsed += deltaTime;
 		return;
 	}
-	// Do we intersect with an asteroid?
-	for (auto ast : GetGame()->GetAsteroids())
-	{
-		if (Intersect(*mCircle, *(ast->GetCircle())))
+	// Do we intersect with an asteroid? (only check nearby ones)
+	GetGame()->GetAsteroidHash()->Query(mCircle->GetCenter(), mCircle->GetRadius(),
+		[this](CircleComponent* circle) {
+		if (Intersect(*mCircle, *circle))
 		{
 			// The first asteroid we intersect with,
 			// set ourselves and the asteroid to dead
 			mSprite->SetTexture(nullptr);
-			ast->SetState(EDead);
+			circle->GetOwner()->SetState(EDead);
 			this->mElapsed = 0.0f;
 			this->mDeadTime = 0.0f;
 			this->mIsDead = true;
-			break;
+			return false;
 		}
-	}
+		return true;
+	});
 }
 
 void Ship::ActorInput(const uint8_t* keyState)
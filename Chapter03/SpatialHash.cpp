@@ -0,0 +1,141 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "SpatialHash.h"
+#include "CircleComponent.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Wrap a cell coordinate into [0, num)
+	int Wrap(int i, int num)
+	{
+		i %= num;
+		return i < 0 ? i + num : i;
+	}
+}
+
+SpatialHash::SpatialHash(const Vector2& worldMin, const Vector2& worldMax)
+	:mWorldMin(worldMin)
+	,mWorldSize(worldMax - worldMin)
+	,mCellSize(mWorldSize)
+	,mNumX(1)
+	,mNumY(1)
+	,mMaxRadius(0.0f)
+{
+	// Everything starts in one cell, until circles are added
+	mCells.resize(1);
+}
+
+void SpatialHash::Add(CircleComponent* circle)
+{
+	float radius = circle->GetRadius();
+	if (radius > mMaxRadius)
+	{
+		mMaxRadius = radius;
+		// Cells as wide as the biggest circle, so a query only has to
+		// look at the neighboring cells
+		Resize(2.0f * mMaxRadius);
+	}
+
+	int cell = GetCell(circle->GetCenter());
+	circle->SetHashCell(cell);
+	mCells[cell].emplace_back(circle);
+}
+
+void SpatialHash::Remove(CircleComponent* circle)
+{
+	std::vector<CircleComponent*>& cell = mCells[circle->GetHashCell()];
+	auto iter = std::find(cell.begin(), cell.end(), circle);
+	if (iter != cell.end())
+	{
+		// Order in a cell doesn't matter, so swap and pop
+		std::iter_swap(iter, cell.end() - 1);
+		cell.pop_back();
+	}
+}
+
+void SpatialHash::Update(CircleComponent* circle)
+{
+	// Grown (by scale) past the biggest radius?
+	if (circle->GetRadius() > mMaxRadius)
+	{
+		Remove(circle);
+		Add(circle);
+		return;
+	}
+
+	int cell = GetCell(circle->GetCenter());
+	if (cell != circle->GetHashCell())
+	{
+		Remove(circle);
+		circle->SetHashCell(cell);
+		mCells[cell].emplace_back(circle);
+	}
+}
+
+void SpatialHash::Query(const Vector2& center, float radius,
+	const std::function<bool(CircleComponent*)>& f) const
+{
+	// Cells the query circle touches, grown by the biggest radius
+	// (since circles are stored by their center)
+	float reach = radius + mMaxRadius;
+	int minX = static_cast<int>(std::floor((center.x - reach - mWorldMin.x) / mCellSize.x));
+	int maxX = static_cast<int>(std::floor((center.x + reach - mWorldMin.x) / mCellSize.x));
+	int minY = static_cast<int>(std::floor((center.y - reach - mWorldMin.y) / mCellSize.y));
+	int maxY = static_cast<int>(std::floor((center.y + reach - mWorldMin.y) / mCellSize.y));
+	// Don't wrap around onto the same cells twice
+	maxX = Math::Min(maxX, minX + mNumX - 1);
+	maxY = Math::Min(maxY, minY + mNumY - 1);
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		int row = Wrap(y, mNumY) * mNumX;
+		for (int x = minX; x <= maxX; x++)
+		{
+			for (auto circle : mCells[row + Wrap(x, mNumX)])
+			{
+				if (!f(circle))
+				{
+					return;
+				}
+			}
+		}
+	}
+}
+
+int SpatialHash::GetCell(const Vector2& pos) const
+{
+	int x = static_cast<int>(std::floor((pos.x - mWorldMin.x) / mCellSize.x));
+	int y = static_cast<int>(std::floor((pos.y - mWorldMin.y) / mCellSize.y));
+	return Wrap(y, mNumY) * mNumX + Wrap(x, mNumX);
+}
+
+void SpatialHash::Resize(float cellSize)
+{
+	std::vector<CircleComponent*> circles;
+	for (auto& cell : mCells)
+	{
+		circles.insert(circles.end(), cell.begin(), cell.end());
+	}
+
+	// Round down the count, so cells are at least cellSize
+	mNumX = Math::Max(1, static_cast<int>(mWorldSize.x / cellSize));
+	mNumY = Math::Max(1, static_cast<int>(mWorldSize.y / cellSize));
+	mCellSize = Vector2(mWorldSize.x / mNumX, mWorldSize.y / mNumY);
+	mCells.clear();
+	mCells.resize(mNumX * mNumY);
+
+	for (auto circle : circles)
+	{
+		int cell = GetCell(circle->GetCenter());
+		circle->SetHashCell(cell);
+		mCells[cell].emplace_back(circle);
+	}
+}
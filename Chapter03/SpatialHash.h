@@ -0,0 +1,47 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <functional>
+#include "Math.h"
+
+// Uniform grid for finding circles near each other. Each circle is in
+// the cell with its center, and cells are at least as big as the biggest
+// circle. The world wraps around at the edges (like the screen wrapping
+// in MoveComponent), so the cells do too.
+class SpatialHash
+{
+public:
+	// The world is the rectangle from worldMin to worldMax
+	SpatialHash(const Vector2& worldMin, const Vector2& worldMax);
+
+	void Add(class CircleComponent* circle);
+	void Remove(class CircleComponent* circle);
+	// Move the circle to the cell its center is in now
+	void Update(class CircleComponent* circle);
+
+	// Calls f with each circle that might overlap the given circle
+	// (f returns false to stop the query)
+	void Query(const Vector2& center, float radius,
+		const std::function<bool(class CircleComponent*)>& f) const;
+private:
+	int GetCell(const Vector2& pos) const;
+	// Make the cells at least cellSize (and put the circles back in)
+	void Resize(float cellSize);
+
+	std::vector<std::vector<class CircleComponent*>> mCells;
+	Vector2 mWorldMin;
+	Vector2 mWorldSize;
+	// Cells evenly divide the world (so wrapping lines up)
+	Vector2 mCellSize;
+	int mNumX;
+	int mNumY;
+	// Biggest radius added (queries reach this far into neighbor cells)
+	float mMaxRadius;
+};
@@ -114,8 +114,12 @@ void Game::UpdateGame()
 {
 	// Compute delta time
 	// Wait until 16ms has elapsed since last frame
-	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + 16))
-		;
+	// (sleep rather than spin, so waiting doesn't burn a core)
+	Uint32 elapsed = SDL_GetTicks() - mTicksCount;
+	if (elapsed < 16)
+	{
+		SDL_Delay(16 - elapsed);
+	}
 
 	float deltaTime = (SDL_GetTicks() - mTicksCount) / 1000.0f;
 	if (deltaTime > 0.05f)
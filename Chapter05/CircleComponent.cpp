@@ -8,14 +8,44 @@
 
 #include "CircleComponent.h"
 #include "Actor.h"
+#include "SpatialHash.h"
 
 CircleComponent::CircleComponent(class Actor* owner)
 :Component(owner)
 ,mRadius(0.0f)
+,mHash(nullptr)
+,mHashCell(0)
 {
 	
 }
 
+CircleComponent::~CircleComponent()
+{
+	SetSpatialHash(nullptr);
+}
+
+void CircleComponent::Update(float deltaTime)
+{
+	// (this updates after MoveComponent, so the center is final)
+	if (mHash)
+	{
+		mHash->Update(this);
+	}
+}
+
+void CircleComponent::SetSpatialHash(SpatialHash* hash)
+{
+	if (mHash)
+	{
+		mHash->Remove(this);
+	}
+	mHash = hash;
+	if (mHash)
+	{
+		mHash->Add(this);
+	}
+}
+
 const Vector2& CircleComponent::GetCenter() const
 {
 	return mOwner->GetPosition();
@@ -18,12 +18,15 @@
 #include "Ship.h"
 #include "Asteroid.h"
 #include "Random.h"
+#include "SpatialHash.h"
+#include "CircleComponent.h"
 
 Game::Game()
 :mWindow(nullptr)
 ,mSpriteShader(nullptr)
 ,mIsRunning(true)
 ,mUpdatingActors(false)
+,mAsteroidHash(nullptr)
 ,mStartColor(0.86f, 0.86f, 0.86f, 1.0f)
 ,mNextColor(1, 0, 0, 1.0f)
 ,mColorTime(0.0f)
@@ -136,8 +139,12 @@ void Game::UpdateGame()
 {
 	// Compute delta time
 	// Wait until 16ms has elapsed since last frame
-	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + 16))
-		;
+	// (sleep rather than spin, so waiting doesn't burn a core)
+	Uint32 elapsed = SDL_GetTicks() - mTicksCount;
+	if (elapsed < 16)
+	{
+		SDL_Delay(16 - elapsed);
+	}
 
 	float deltaTime = (SDL_GetTicks() - mTicksCount) / 1000.0f;
 	if (deltaTime > 0.05f)
@@ -251,6 +258,10 @@ void Game::CreateSpriteVerts()
 
 void Game::LoadData()
 {
+	// Same bounds as the screen wrapping in MoveComponent
+	mAsteroidHash = new SpatialHash(Vector2(-512.0f, -384.0f),
+		Vector2(512.0f, 384.0f));
+
 	// Create player's ship
 	mShip = new Ship(this);
 	mShip->SetRotation(Math::PiOver2);
@@ -271,6 +282,8 @@ void Game::UnloadData()
 	{
 		delete mActors.back();
 	}
+	delete mAsteroidHash;
+	mAsteroidHash = nullptr;
 
 	// Destroy textures
 	for (auto i : mTextures)
@@ -308,6 +321,7 @@ Texture* Game::GetTexture(const std::string& fileName)
 void Game::AddAsteroid(Asteroid* ast)
 {
 	mAsteroids.emplace_back(ast);
+	ast->GetCircle()->SetSpatialHash(mAsteroidHash);
 }
 
 void Game::RemoveAsteroid(Asteroid* ast)
@@ -318,6 +332,7 @@ void Game::RemoveAsteroid(Asteroid* ast)
 	{
 		mAsteroids.erase(iter);
 	}
+	ast->GetCircle()->SetSpatialHash(nullptr);
 }
 
 void Game::Shutdown()
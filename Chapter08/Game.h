@@ -33,6 +33,8 @@ public:
 	void AddAsteroid(class Asteroid* ast);
 	void RemoveAsteroid(class Asteroid* ast);
 	std::vector<class Asteroid*>& GetAsteroids() { return mAsteroids; }
+	// Asteroids' circles, for finding the ones near a point
+	class SpatialHash* GetAsteroidHash() { return mAsteroidHash; }
 private:
 	void ProcessInput();
 	void UpdateGame();
@@ -71,4 +73,5 @@ private:
 	// Game-specific
 	class Ship* mShip;
 	std::vector<class Asteroid*> mAsteroids;
+	class SpatialHash* mAsteroidHash;
 };
@@ -0,0 +1,493 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "AABBTree.h"
+#include <algorithm>
+
+namespace
+{
+	// Deep enough for any balanced tree that fits in memory
+	const int MaxStack = 256;
+
+	AABB Union(const AABB& a, const AABB& b)
+	{
+		return AABB(Vector3(Math::Min(a.mMin.x, b.mMin.x),
+				Math::Min(a.mMin.y, b.mMin.y),
+				Math::Min(a.mMin.z, b.mMin.z)),
+			Vector3(Math::Max(a.mMax.x, b.mMax.x),
+				Math::Max(a.mMax.y, b.mMax.y),
+				Math::Max(a.mMax.z, b.mMax.z)));
+	}
+
+	// Half the surface area (enough to compare costs)
+	float Area(const AABB& box)
+	{
+		Vector3 d = box.mMax - box.mMin;
+		return d.x * d.y + d.y * d.z + d.z * d.x;
+	}
+
+	bool Contains(const AABB& outer, const AABB& inner)
+	{
+		return outer.mMin.x <= inner.mMin.x && outer.mMin.y <= inner.mMin.y &&
+			outer.mMin.z <= inner.mMin.z && outer.mMax.x >= inner.mMax.x &&
+			outer.mMax.y >= inner.mMax.y && outer.mMax.z >= inner.mMax.z;
+	}
+
+	// Does the segment start + delta * t, for t in [0, maxT], touch the box?
+	bool SegmentOverlaps(const Vector3& start, const Vector3& delta,
+		float maxT, const AABB& box)
+	{
+		const float s[3] = { start.x, start.y, start.z };
+		const float d[3] = { delta.x, delta.y, delta.z };
+		const float bmin[3] = { box.mMin.x, box.mMin.y, box.mMin.z };
+		const float bmax[3] = { box.mMax.x, box.mMax.y, box.mMax.z };
+		float tMin = 0.0f;
+		float tMax = maxT;
+		for (int i = 0; i < 3; i++)
+		{
+			if (Math::NearZero(d[i]))
+			{
+				// Parallel to this slab, so must start inside it
+				if (s[i] < bmin[i] || s[i] > bmax[i])
+				{
+					return false;
+				}
+			}
+			else
+			{
+				float inv = 1.0f / d[i];
+				float t1 = (bmin[i] - s[i]) * inv;
+				float t2 = (bmax[i] - s[i]) * inv;
+				if (t1 > t2)
+				{
+					std::swap(t1, t2);
+				}
+				tMin = Math::Max(tMin, t1);
+				tMax = Math::Min(tMax, t2);
+				if (tMin > tMax)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+AABBTree::AABBTree(float margin)
+	:mRoot(NullNode)
+	,mFreeList(NullNode)
+	,mNumProxies(0)
+	,mMargin(margin)
+{
+}
+
+int AABBTree::CreateProxy(const AABB& box, void* userData)
+{
+	int proxy = AllocateNode();
+	Node& node = mNodes[proxy];
+	Vector3 margin(mMargin, mMargin, mMargin);
+	node.mBox = AABB(box.mMin - margin, box.mMax + margin);
+	node.mUserData = userData;
+	node.mHeight = 0;
+	InsertLeaf(proxy);
+	mNumProxies++;
+	return proxy;
+}
+
+void AABBTree::DestroyProxy(int proxyID)
+{
+	RemoveLeaf(proxyID);
+	FreeNode(proxyID);
+	mNumProxies--;
+}
+
+bool AABBTree::MoveProxy(int proxyID, const AABB& box)
+{
+	if (Contains(mNodes[proxyID].mBox, box))
+	{
+		// Still inside the fat box, so the tree doesn't change
+		return false;
+	}
+
+	RemoveLeaf(proxyID);
+	Vector3 margin(mMargin, mMargin, mMargin);
+	mNodes[proxyID].mBox = AABB(box.mMin - margin, box.mMax + margin);
+	InsertLeaf(proxyID);
+	return true;
+}
+
+void AABBTree::Query(const AABB& box, const std::function<bool(int)>& f) const
+{
+	if (mRoot == NullNode)
+	{
+		return;
+	}
+
+	int stack[MaxStack];
+	int count = 0;
+	stack[count++] = mRoot;
+	while (count > 0)
+	{
+		const Node& node = mNodes[stack[--count]];
+		if (!Intersect(node.mBox, box))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (!f(static_cast<int>(&node - mNodes.data())))
+			{
+				return;
+			}
+		}
+		else if (count + 2 <= MaxStack)
+		{
+			stack[count++] = node.mChild1;
+			stack[count++] = node.mChild2;
+		}
+	}
+}
+
+void AABBTree::RayCast(const LineSegment& l,
+	const std::function<float(int, float)>& f) const
+{
+	if (mRoot == NullNode)
+	{
+		return;
+	}
+
+	Vector3 delta = l.mEnd - l.mStart;
+	float maxT = 1.0f;
+	int stack[MaxStack];
+	int count = 0;
+	stack[count++] = mRoot;
+	while (count > 0)
+	{
+		int index = stack[--count];
+		const Node& node = mNodes[index];
+		// Only boxes the segment enters before the closest hit so far
+		if (!SegmentOverlaps(l.mStart, delta, maxT, node.mBox))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			maxT = f(index, maxT);
+			if (maxT <= 0.0f)
+			{
+				return;
+			}
+		}
+		else if (count + 2 <= MaxStack)
+		{
+			stack[count++] = node.mChild1;
+			stack[count++] = node.mChild2;
+		}
+	}
+}
+
+void AABBTree::QueryPairs(const std::function<void(int, int)>& f) const
+{
+	for (size_t i = 0; i < mNodes.size(); i++)
+	{
+		const Node& node = mNodes[i];
+		if (node.mHeight != 0)
+		{
+			// Not a leaf (or free)
+			continue;
+		}
+
+		int proxy = static_cast<int>(i);
+		Query(node.mBox, [proxy, &f](int other) {
+			// Each pair only once
+			if (other > proxy)
+			{
+				f(proxy, other);
+			}
+			return true;
+		});
+	}
+}
+
+int AABBTree::GetHeight() const
+{
+	return mRoot == NullNode ? 0 : mNodes[mRoot].mHeight;
+}
+
+int AABBTree::AllocateNode()
+{
+	if (mFreeList == NullNode)
+	{
+		Node node{ AABB(Vector3::Zero, Vector3::Zero), nullptr,
+			NullNode, NullNode, NullNode, -1 };
+		mNodes.emplace_back(node);
+		mFreeList = static_cast<int>(mNodes.size()) - 1;
+	}
+
+	int index = mFreeList;
+	Node& node = mNodes[index];
+	mFreeList = node.mParent;
+	node.mParent = NullNode;
+	node.mChild1 = NullNode;
+	node.mChild2 = NullNode;
+	node.mHeight = 0;
+	node.mUserData = nullptr;
+	return index;
+}
+
+void AABBTree::FreeNode(int node)
+{
+	mNodes[node].mParent = mFreeList;
+	mNodes[node].mHeight = -1;
+	mFreeList = node;
+}
+
+void AABBTree::InsertLeaf(int leaf)
+{
+	if (mRoot == NullNode)
+	{
+		mRoot = leaf;
+		mNodes[leaf].mParent = NullNode;
+		return;
+	}
+
+	// Walk down to the best sibling for the leaf: the cost of a node
+	// is the area it adds, plus the area its ancestors grow by
+	AABB leafBox = mNodes[leaf].mBox;
+	int index = mRoot;
+	while (!mNodes[index].IsLeaf())
+	{
+		const Node& node = mNodes[index];
+		float area = Area(node.mBox);
+		float combinedArea = Area(Union(node.mBox, leafBox));
+
+		// Cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+		// Minimum cost of pushing the leaf further down
+		float inheritCost = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		int children[2] = { node.mChild1, node.mChild2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = mNodes[children[i]];
+			float grown = Area(Union(leafBox, child.mBox));
+			childCost[i] = (child.IsLeaf() ? grown : grown - Area(child.mBox)) +
+				inheritCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+		{
+			break;
+		}
+		index = childCost[0] < childCost[1] ? children[0] : children[1];
+	}
+
+	// New parent for the sibling and the leaf
+	int sibling = index;
+	int oldParent = mNodes[sibling].mParent;
+	int newParent = AllocateNode();
+	mNodes[newParent].mParent = oldParent;
+	mNodes[newParent].mBox = Union(leafBox, mNodes[sibling].mBox);
+	mNodes[newParent].mHeight = mNodes[sibling].mHeight + 1;
+	mNodes[newParent].mChild1 = sibling;
+	mNodes[newParent].mChild2 = leaf;
+	mNodes[sibling].mParent = newParent;
+	mNodes[leaf].mParent = newParent;
+
+	if (oldParent != NullNode)
+	{
+		if (mNodes[oldParent].mChild1 == sibling)
+		{
+			mNodes[oldParent].mChild1 = newParent;
+		}
+		else
+		{
+			mNodes[oldParent].mChild2 = newParent;
+		}
+	}
+	else
+	{
+		mRoot = newParent;
+	}
+
+	FixUpwards(mNodes[leaf].mParent);
+}
+
+void AABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == mRoot)
+	{
+		mRoot = NullNode;
+		return;
+	}
+
+	// The sibling takes the parent's place
+	int parent = mNodes[leaf].mParent;
+	int grandParent = mNodes[parent].mParent;
+	int sibling = mNodes[parent].mChild1 == leaf ?
+		mNodes[parent].mChild2 : mNodes[parent].mChild1;
+
+	if (grandParent != NullNode)
+	{
+		if (mNodes[grandParent].mChild1 == parent)
+		{
+			mNodes[grandParent].mChild1 = sibling;
+		}
+		else
+		{
+			mNodes[grandParent].mChild2 = sibling;
+		}
+		mNodes[sibling].mParent = grandParent;
+		FreeNode(parent);
+		FixUpwards(grandParent);
+	}
+	else
+	{
+		mRoot = sibling;
+		mNodes[sibling].mParent = NullNode;
+		FreeNode(parent);
+	}
+}
+
+void AABBTree::FixUpwards(int index)
+{
+	while (index != NullNode)
+	{
+		index = Balance(index);
+
+		Node& node = mNodes[index];
+		const Node& child1 = mNodes[node.mChild1];
+		const Node& child2 = mNodes[node.mChild2];
+		node.mHeight = 1 + std::max(child1.mHeight, child2.mHeight);
+		node.mBox = Union(child1.mBox, child2.mBox);
+
+		index = node.mParent;
+	}
+}
+
+int AABBTree::Balance(int iA)
+{
+	Node& A = mNodes[iA];
+	if (A.IsLeaf() || A.mHeight < 2)
+	{
+		return iA;
+	}
+
+	int iB = A.mChild1;
+	int iC = A.mChild2;
+	Node& B = mNodes[iB];
+	Node& C = mNodes[iC];
+	int balance = C.mHeight - B.mHeight;
+
+	// C is too tall, so rotate it up to A's place
+	if (balance > 1)
+	{
+		int iF = C.mChild1;
+		int iG = C.mChild2;
+		Node& F = mNodes[iF];
+		Node& G = mNodes[iG];
+
+		C.mChild1 = iA;
+		C.mParent = A.mParent;
+		A.mParent = iC;
+		if (C.mParent != NullNode)
+		{
+			if (mNodes[C.mParent].mChild1 == iA)
+			{
+				mNodes[C.mParent].mChild1 = iC;
+			}
+			else
+			{
+				mNodes[C.mParent].mChild2 = iC;
+			}
+		}
+		else
+		{
+			mRoot = iC;
+		}
+
+		// The taller of C's children stays with C
+		if (F.mHeight > G.mHeight)
+		{
+			C.mChild2 = iF;
+			A.mChild2 = iG;
+			G.mParent = iA;
+			A.mBox = Union(B.mBox, G.mBox);
+			C.mBox = Union(A.mBox, F.mBox);
+			A.mHeight = 1 + std::max(B.mHeight, G.mHeight);
+			C.mHeight = 1 + std::max(A.mHeight, F.mHeight);
+		}
+		else
+		{
+			C.mChild2 = iG;
+			A.mChild2 = iF;
+			F.mParent = iA;
+			A.mBox = Union(B.mBox, F.mBox);
+			C.mBox = Union(A.mBox, G.mBox);
+			A.mHeight = 1 + std::max(B.mHeight, F.mHeight);
+			C.mHeight = 1 + std::max(A.mHeight, G.mHeight);
+		}
+		return iC;
+	}
+
+	// B is too tall, so rotate it up
+	if (balance < -1)
+	{
+		int iD = B.mChild1;
+		int iE = B.mChild2;
+		Node& D = mNodes[iD];
+		Node& E = mNodes[iE];
+
+		B.mChild1 = iA;
+		B.mParent = A.mParent;
+		A.mParent = iB;
+		if (B.mParent != NullNode)
+		{
+			if (mNodes[B.mParent].mChild1 == iA)
+			{
+				mNodes[B.mParent].mChild1 = iB;
+			}
+			else
+			{
+				mNodes[B.mParent].mChild2 = iB;
+			}
+		}
+		else
+		{
+			mRoot = iB;
+		}
+
+		if (D.mHeight > E.mHeight)
+		{
+			B.mChild2 = iD;
+			A.mChild1 = iE;
+			E.mParent = iA;
+			A.mBox = Union(C.mBox, E.mBox);
+			B.mBox = Union(A.mBox, D.mBox);
+			A.mHeight = 1 + std::max(C.mHeight, E.mHeight);
+			B.mHeight = 1 + std::max(A.mHeight, D.mHeight);
+		}
+		else
+		{
+			B.mChild2 = iE;
+			A.mChild1 = iD;
+			D.mParent = iA;
+			A.mBox = Union(C.mBox, D.mBox);
+			B.mBox = Union(A.mBox, E.mBox);
+			A.mHeight = 1 + std::max(C.mHeight, D.mHeight);
+			B.mHeight = 1 + std::max(A.mHeight, E.mHeight);
+		}
+		return iB;
+	}
+
+	return iA;
+}
@@ -0,0 +1,79 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <functional>
+#include "Collision.h"
+
+// Bounding volume hierarchy of AABBs that's updated incrementally
+// (a dynamic AABB tree). Each leaf (proxy) stores a "fat" box, a bit
+// bigger than the real one, so small movements don't touch the tree.
+// Inserting picks the sibling with the least added surface area, and
+// the tree is rebalanced with rotations on the way back up.
+class AABBTree
+{
+public:
+	// Fat boxes are grown by margin on every side
+	AABBTree(float margin);
+
+	// Returns the proxy ID for the box
+	int CreateProxy(const AABB& box, void* userData);
+	void DestroyProxy(int proxyID);
+	// Returns true if the box left its fat box (and was reinserted)
+	bool MoveProxy(int proxyID, const AABB& box);
+
+	void* GetUserData(int proxyID) const { return mNodes[proxyID].mUserData; }
+	const AABB& GetFatBox(int proxyID) const { return mNodes[proxyID].mBox; }
+
+	// Calls f with each proxy whose fat box overlaps box
+	// (f returns false to stop the query)
+	void Query(const AABB& box, const std::function<bool(int)>& f) const;
+	// Calls f with each proxy whose fat box the segment enters before
+	// maxT (which starts at 1). f returns the new maxT: the t of a hit
+	// to only look for closer ones, maxT to keep going, or 0 to stop.
+	void RayCast(const LineSegment& l,
+		const std::function<float(int, float)>& f) const;
+	// Calls f once for each pair of proxies whose fat boxes overlap
+	void QueryPairs(const std::function<void(int, int)>& f) const;
+
+	int GetHeight() const;
+	int GetNumProxies() const { return mNumProxies; }
+	size_t GetMemoryUsage() const { return mNodes.capacity() * sizeof(Node); }
+
+	static const int NullNode = -1;
+private:
+	struct Node
+	{
+		AABB mBox;
+		void* mUserData;
+		// Parent, or the next free node when on the free list
+		int mParent;
+		int mChild1;
+		int mChild2;
+		// Leaves are 0, free nodes are -1
+		int mHeight;
+
+		bool IsLeaf() const { return mChild1 == NullNode; }
+	};
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	// Rotate the subtree at index if it's unbalanced (returns its new root)
+	int Balance(int index);
+	// Refit boxes and heights from index up to the root
+	void FixUpwards(int index);
+
+	std::vector<Node> mNodes;
+	int mRoot;
+	int mFreeList;
+	int mNumProxies;
+	float mMargin;
+};
@@ -10,6 +10,11 @@
 #include "Game.h"
 #include "Component.h"
 #include "LevelLoader.h"
+#include "ComponentRegistry.h"
+#include "ObjectPool.h"
+#include "TransformSystem.h"
+#include <algorithm>
+#include <SDL/SDL_log.h>
 
 const char* Actor::TypeNames[NUM_ACTOR_TYPES] = {
 	"Actor",
@@ -21,18 +26,25 @@ const char* Actor::TypeNames[NUM_ACTOR_TYPES] = {
 
 Actor::Actor(Game* game)
 	:mState(EActive)
-	,mPosition(Vector3::Zero)
-	,mRotation(Quaternion::Identity)
-	,mScale(1.0f)
+	,mTransforms(game->GetTransformSystem())
+	,mParent(nullptr)
 	,mGame(game)
-	,mRecomputeTransform(true)
 {
+	mTransformIndex = mTransforms->AddTransform(this);
 	mGame->AddActor(this);
 }
 
 Actor::~Actor()
 {
 	mGame->RemoveActor(this);
+	// Children outlive their parent, but are detached
+	// (keeping their local transform)
+	while (!mChildren.empty())
+	{
+		mChildren.back()->SetParent(nullptr);
+	}
+	SetParent(nullptr);
+	mTransforms->RemoveTransform(mTransformIndex);
 	// Need to delete components
 	// Because ~Component calls RemoveComponent, need a different style loop
 	while (!mComponents.empty())
@@ -41,24 +53,21 @@ Actor::~Actor()
 	}
 }
 
-void Actor::Update(float deltaTime)
+void* Actor::operator new(size_t size)
 {
-	if (mState == EActive)
-	{
-		if (mRecomputeTransform)
-		{
-			ComputeWorldTransform();
-		}
-		UpdateComponents(deltaTime);
-		UpdateActor(deltaTime);
-	}
+	return ObjectAllocator::Allocate(size);
 }
 
-void Actor::UpdateComponents(float deltaTime)
+void Actor::operator delete(void* ptr)
 {
-	for (auto comp : mComponents)
+	ObjectAllocator::Free(ptr);
+}
+
+void Actor::Update(float deltaTime)
+{
+	if (mState == EActive)
 	{
-		comp->Update(deltaTime);
+		UpdateActor(deltaTime);
 	}
 }
 
@@ -85,14 +94,48 @@ void Actor::ActorInput(const uint8_t* keyState)
 
 }
 
+Vector3 Actor::GetWorldPosition() const
+{
+	if (mParent)
+	{
+		return GetWorldTransform().GetTranslation();
+	}
+	return GetPosition();
+}
+
+Quaternion Actor::GetWorldRotation() const
+{
+	if (mParent)
+	{
+		// Rotate by ours, followed by the parent's
+		return Quaternion::Concatenate(GetRotation(), mParent->GetWorldRotation());
+	}
+	return GetRotation();
+}
+
+float Actor::GetWorldScale() const
+{
+	if (mParent)
+	{
+		return GetScale() * mParent->GetWorldScale();
+	}
+	return GetScale();
+}
+
 void Actor::ComputeWorldTransform()
 {
-	mRecomputeTransform = false;
-	// Scale, then rotate, then translate
-	mWorldTransform = Matrix4::CreateScale(mScale);
-	mWorldTransform *= Matrix4::CreateFromQuaternion(mRotation);
-	mWorldTransform *= Matrix4::CreateTranslation(mPosition);
+	mTransforms->ComputeWorldTransform(mTransformIndex);
+	OnUpdateWorldTransform();
+
+	// Children depend on this world transform
+	for (auto child : mChildren)
+	{
+		child->ComputeWorldTransform();
+	}
+}
 
+void Actor::OnUpdateWorldTransform()
+{
 	// Inform components world transform updated
 	for (auto comp : mComponents)
 	{
@@ -100,6 +143,41 @@ void Actor::ComputeWorldTransform()
 	}
 }
 
+void Actor::SetParent(Actor* parent)
+{
+	if (parent == mParent)
+	{
+		return;
+	}
+
+	// Don't allow a cycle (attaching to our own descendant)
+	for (Actor* a = parent; a; a = a->mParent)
+	{
+		if (a == this)
+		{
+			SDL_Log("Actor can't be attached to its own child");
+			return;
+		}
+	}
+
+	if (mParent)
+	{
+		auto iter = std::find(mParent->mChildren.begin(),
+			mParent->mChildren.end(), this);
+		if (iter != mParent->mChildren.end())
+		{
+			mParent->mChildren.erase(iter);
+		}
+	}
+
+	mParent = parent;
+	if (mParent)
+	{
+		mParent->mChildren.emplace_back(this);
+	}
+	mTransforms->SetHasParent(mTransformIndex, mParent != nullptr);
+}
+
 void Actor::RotateToNewForward(const Vector3& forward)
 {
 	// Figure out difference between original (unit x) and new
@@ -142,6 +220,9 @@ void Actor::AddComponent(Component* component)
 
 	// Inserts element before position of iterator
 	mComponents.insert(iter, component);
+
+	// The registry is what actually updates components
+	mGame->GetComponentRegistry()->AddComponent(component);
 }
 
 void Actor::RemoveComponent(Component* component)
@@ -151,6 +232,7 @@ void Actor::RemoveComponent(Component* component)
 	{
 		mComponents.erase(iter);
 	}
+	mGame->GetComponentRegistry()->RemoveComponent(component);
 }
 
 void Actor::LoadProperties(const rapidjson::Value& inObj)
@@ -174,9 +256,15 @@ void Actor::LoadProperties(const rapidjson::Value& inObj)
 	}
 
 	// Load position, rotation, and scale, and compute transform
-	JsonHelper::GetVector3(inObj, "position", mPosition);
-	JsonHelper::GetQuaternion(inObj, "rotation", mRotation);
-	JsonHelper::GetFloat(inObj, "scale", mScale);
+	Vector3 pos = GetPosition();
+	JsonHelper::GetVector3(inObj, "position", pos);
+	SetPosition(pos);
+	Quaternion rot = GetRotation();
+	JsonHelper::GetQuaternion(inObj, "rotation", rot);
+	SetRotation(rot);
+	float scale = GetScale();
+	JsonHelper::GetFloat(inObj, "scale", scale);
+	SetScale(scale);
 	ComputeWorldTransform();
 }
 
@@ -193,7 +281,7 @@ void Actor::SaveProperties(rapidjson::Document::AllocatorType& alloc, rapidjson:
 	}
 
 	JsonHelper::AddString(alloc, inObj, "state", state);
-	JsonHelper::AddVector3(alloc, inObj, "position", mPosition);
-	JsonHelper::AddQuaternion(alloc, inObj, "rotation", mRotation);
-	JsonHelper::AddFloat(alloc, inObj, "scale", mScale);
+	JsonHelper::AddVector3(alloc, inObj, "position", GetPosition());
+	JsonHelper::AddQuaternion(alloc, inObj, "rotation", GetRotation());
+	JsonHelper::AddFloat(alloc, inObj, "scale", GetScale());
 }
@@ -11,6 +11,8 @@
 #include "Math.h"
 #include <rapidjson/document.h>
 #include "Component.h"
+#include "SlotMap.h"
+#include "TransformSystem.h"
 
 class Actor
 {
@@ -38,10 +40,13 @@ public:
 	Actor(class Game* game);
 	virtual ~Actor();
 
+	// Actors are allocated through ObjectAllocator (pooled per size)
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+
 	// Update function called from Game (not overridable)
+	// (components update separately, in the game's ComponentRegistry)
 	void Update(float deltaTime);
-	// Updates all the components attached to the actor (not overridable)
-	void UpdateComponents(float deltaTime);
 	// Any actor-specific update code (overridable)
 	virtual void UpdateActor(float deltaTime);
 	// ProcessInput function called from Game (not overridable)
@@ -50,18 +55,42 @@ public:
 	virtual void ActorInput(const uint8_t* keyState);
 
 	// Getters/setters
-	const Vector3& GetPosition() const { return mPosition; }
-	void SetPosition(const Vector3& pos) { mPosition = pos; mRecomputeTransform = true; }
-	float GetScale() const { return mScale; }
-	void SetScale(float scale) { mScale = scale; mRecomputeTransform = true; }
-	const Quaternion& GetRotation() const { return mRotation; }
-	void SetRotation(const Quaternion& rotation) { mRotation = rotation;   mRecomputeTransform = true; }
+	// (position, rotation, and scale are relative to the parent, if any)
+	Vector3 GetPosition() const { return mTransforms->GetPosition(mTransformIndex); }
+	void SetPosition(const Vector3& pos) { mTransforms->SetPosition(mTransformIndex, pos); }
+	float GetScale() const { return mTransforms->GetScale(mTransformIndex); }
+	void SetScale(float scale) { mTransforms->SetScale(mTransformIndex, scale); }
+	Quaternion GetRotation() const { return mTransforms->GetRotation(mTransformIndex); }
+	void SetRotation(const Quaternion& rotation) { mTransforms->SetRotation(mTransformIndex, rotation); }
+
+	// Position, rotation, and scale after any parent transforms
+	Vector3 GetWorldPosition() const;
+	Quaternion GetWorldRotation() const;
+	float GetWorldScale() const;
 	
+	// Recompute the world transform right away (along with any
+	// children's). Usually the TransformSystem does this in a batch.
 	void ComputeWorldTransform();
-	const Matrix4& GetWorldTransform() const { return mWorldTransform; }
+	const Matrix4& GetWorldTransform() const { return mTransforms->GetWorldTransform(mTransformIndex); }
+	// Inform components the world transform changed
+	// (may run on a job thread, see Component::OnUpdateWorldTransform)
+	void OnUpdateWorldTransform();
+
+	// World transform to draw with (interpolated between ticks)
+	const Matrix4& GetRenderTransform() const { return mTransforms->GetRenderTransform(mTransformIndex); }
+
+	// Attach to a parent actor, so this actor's transform is relative
+	// to it and follows it around (nullptr to detach)
+	void SetParent(Actor* parent);
+	Actor* GetParent() const { return mParent; }
+	const std::vector<Actor*>& GetChildren() const { return mChildren; }
+
+	// Index into the TransformSystem (changes as actors are removed)
+	size_t GetTransformIndex() const { return mTransformIndex; }
+	void SetTransformIndex(size_t index) { mTransformIndex = index; }
 
-	Vector3 GetForward() const { return Vector3::Transform(Vector3::UnitX, mRotation); }
-	Vector3 GetRight() const { return Vector3::Transform(Vector3::UnitY, mRotation); }
+	Vector3 GetForward() const { return Vector3::Transform(Vector3::UnitX, GetRotation()); }
+	Vector3 GetRight() const { return Vector3::Transform(Vector3::UnitY, GetRotation()); }
 
 	void RotateToNewForward(const Vector3& forward);
 
@@ -69,6 +98,9 @@ public:
 	void SetState(State state) { mState = state; }
 
 	class Game* GetGame() { return mGame; }
+	// Handle into the game's actors (null while still pending)
+	SlotHandle GetHandle() const { return mHandle; }
+	void SetHandle(SlotHandle handle) { mHandle = handle; }
 
 
 	// Add/remove components
@@ -113,13 +145,13 @@ private:
 	// Actor's state
 	State mState;
 
-	// Transform
-	Matrix4 mWorldTransform;
-	Vector3 mPosition;
-	Quaternion mRotation;
-	float mScale;
-	bool mRecomputeTransform;
+	// Transform (stored in the game's TransformSystem)
+	class TransformSystem* mTransforms;
+	size_t mTransformIndex;
+	Actor* mParent;
+	std::vector<Actor*> mChildren;
 
 	std::vector<Component*> mComponents;
 	class Game* mGame;
+	SlotHandle mHandle;
 };
@@ -10,6 +10,7 @@
 #include "Actor.h"
 #include "Game.h"
 #include "AudioSystem.h"
+#include "CommandBuffer.h"
 
 AudioComponent::AudioComponent(Actor* owner, int updateOrder)
 	:Component(owner, updateOrder)
@@ -57,14 +58,21 @@ void AudioComponent::Update(float deltaTime)
 void AudioComponent::OnUpdateWorldTransform()
 {
 	// Update 3D events' world transforms
-	Matrix4 world = mOwner->GetWorldTransform();
-	for (auto& event : mEvents3D)
+	// (FMOD isn't safe to call from job threads, so defer)
+	if (mEvents3D.empty())
 	{
-		if (event.IsValid())
+		return;
+	}
+	Matrix4 world = mOwner->GetWorldTransform();
+	mOwner->GetGame()->GetCommandBuffer()->Push([this, world]() {
+		for (auto& event : mEvents3D)
 		{
-			event.Set3DAttributes(world);
+			if (event.IsValid())
+			{
+				event.Set3DAttributes(world);
+			}
 		}
-	}
+	});
 }
 
 SoundEvent AudioComponent::PlayEvent(const std::string& name)
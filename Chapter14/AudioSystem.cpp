@@ -11,6 +11,7 @@
 #include <fmod_studio.hpp>
 #include <fmod_errors.h>
 #include <vector>
+#include "Profiler.h"
 
 unsigned int AudioSystem::sNextID = 0;
 
@@ -238,6 +239,7 @@ SoundEvent AudioSystem::PlayEvent(const std::string& name)
 
 void AudioSystem::Update(float deltaTime)
 {
+	PROFILE_SCOPE("AudioSystem::Update");
 	// Find any stopped event instances
 	std::vector<unsigned int> done;
 	for (auto& iter : mEventInstances)
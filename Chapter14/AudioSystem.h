@@ -30,27 +30,27 @@ class AudioSystem
 {
 public:
 	AudioSystem(class Game* game);
-	~AudioSystem();
+	virtual ~AudioSystem();
 
-	bool Initialize();
-	void Shutdown();
+	virtual bool Initialize();
+	virtual void Shutdown();
 
 	// Load/unload banks
-	void LoadBank(const std::string& name);
-	void UnloadBank(const std::string& name);
-	void UnloadAllBanks();
+	virtual void LoadBank(const std::string& name);
+	virtual void UnloadBank(const std::string& name);
+	virtual void UnloadAllBanks();
 
-	SoundEvent PlayEvent(const std::string& name);
+	virtual SoundEvent PlayEvent(const std::string& name);
 
-	void Update(float deltaTime);
+	virtual void Update(float deltaTime);
 
 	// For positional audio
-	void SetListener(const Matrix4& viewMatrix);
+	virtual void SetListener(const Matrix4& viewMatrix);
 	// Control buses
-	float GetBusVolume(const std::string& name) const;
-	bool GetBusPaused(const std::string& name) const;
-	void SetBusVolume(const std::string& name, float volume);
-	void SetBusPaused(const std::string& name, bool pause);
+	virtual float GetBusVolume(const std::string& name) const;
+	virtual bool GetBusPaused(const std::string& name) const;
+	virtual void SetBusVolume(const std::string& name, float volume);
+	virtual void SetBusPaused(const std::string& name, bool pause);
 protected:
 	friend class SoundEvent;
 	FMOD::Studio::EventInstance* GetEventInstance(unsigned int id);
@@ -25,6 +25,7 @@ BallActor::BallActor(Game* game)
 	mc->SetMesh(mesh);
 	BallMove* move = new BallMove(this);
 	move->SetForwardSpeed(1500.0f);
+	move->SetRadius(mesh->GetRadius() * GetScale());
 	mAudioComp = new AudioComponent(this);
 }
 
@@ -12,30 +12,47 @@
 #include "PhysWorld.h"
 #include "TargetActor.h"
 #include "BallActor.h"
+#include "LevelLoader.h"
+
+namespace
+{
+	// Most bounces in one tick (in case it's wedged in a corner)
+	const int MaxBounces = 4;
+	// Stop this far short of the box, so the next sweep starts clear
+	const float SkinWidth = 0.01f;
+}
 
 BallMove::BallMove(Actor* owner)
 	:MoveComponent(owner)
+	,mRadius(0.0f)
 {
 }
 
 void BallMove::Update(float deltaTime)
 {
-	const float segmentLength = 30.0f;
 	PhysWorld* phys = mOwner->GetGame()->GetPhysWorld();
 
-	// Construct segment in direction of travel
-	Vector3 start = mOwner->GetPosition();
+	Vector3 pos = mOwner->GetPosition();
 	Vector3 dir = mOwner->GetForward();
-	Vector3 end = start + dir * segmentLength;
-	// Create line segment
-	LineSegment l(start, end);
-	// Test segment vs world
-	PhysWorld::CollisionInfo info;
-	if (phys->SegmentCast(l, info))
+	float distance = mForwardSpeed * deltaTime;
+	bool bounced = false;
+	for (int i = 0; i < MaxBounces && distance > 0.0f; i++)
 	{
-		// If we collided, reflect the ball about the normal
+		// Sweep the ball over the rest of this tick's movement
+		Vector3 end = pos + dir * distance;
+		PhysWorld::CollisionInfo info;
+		float t;
+		if (!phys->SweepSphere(Sphere(pos, mRadius), end, info, t))
+		{
+			pos = end;
+			break;
+		}
+
+		// Move up to the time of impact, and reflect about the normal
+		pos = Vector3::Lerp(pos, end, t) + info.mNormal * SkinWidth;
+		distance *= 1.0f - t;
 		dir = Vector3::Reflect(dir, info.mNormal);
-		mOwner->RotateToNewForward(dir);
+		bounced = true;
 		// Did we hit a target?
 		TargetActor* target = dynamic_cast<TargetActor*>(info.mActor);
 		if (target)
@@ -43,5 +60,23 @@ void BallMove::Update(float deltaTime)
 			static_cast<BallActor*>(mOwner)->HitTarget();
 		}
 	}
-	MoveComponent::Update(deltaTime);
+
+	mOwner->SetPosition(pos);
+	if (bounced)
+	{
+		mOwner->RotateToNewForward(dir);
+	}
+}
+
+void BallMove::LoadProperties(const rapidjson::Value& inObj)
+{
+	MoveComponent::LoadProperties(inObj);
+	JsonHelper::GetFloat(inObj, "radius", mRadius);
+}
+
+void BallMove::SaveProperties(rapidjson::Document::AllocatorType& alloc,
+	rapidjson::Value& inObj) const
+{
+	MoveComponent::SaveProperties(alloc, inObj);
+	JsonHelper::AddFloat(alloc, inObj, "radius", mRadius);
 }
@@ -14,8 +14,19 @@ class BallMove : public MoveComponent
 public:
 	BallMove(class Actor* owner);
 
+	// Moves the ball with continuous collision, bouncing off boxes
+	// (so it can't tunnel through them, however fast it's going)
 	void Update(float deltaTime) override;
+	// Hitting a target plays audio, so this has to stay on the main thread
+	bool GetIsThreadSafe() const override { return false; }
 
 	TypeID GetType() const override { return TBallMove; }
+
+	void SetRadius(float radius) { mRadius = radius; }
+
+	void LoadProperties(const rapidjson::Value& inObj) override;
+	void SaveProperties(rapidjson::Document::AllocatorType& alloc,
+		rapidjson::Value& inObj) const override;
 protected:
+	float mRadius;
 };
\ No newline at end of file
@@ -10,20 +10,47 @@
 #include "Actor.h"
 #include "Game.h"
 #include "PhysWorld.h"
+#include "RigidBodyComponent.h"
 #include "LevelLoader.h"
+#include "CommandBuffer.h"
 
 BoxComponent::BoxComponent(Actor* owner, int updateOrder)
 	:Component(owner, updateOrder)
 	,mObjectBox(Vector3::Zero, Vector3::Zero)
 	,mWorldBox(Vector3::Zero, Vector3::Zero)
+	,mWorldOBB(Vector3::Zero, Quaternion::Identity, Vector3::Zero)
 	,mShouldRotate(true)
+	,mIsRotated(false)
+	,mLayer(PhysWorld::ELayerDefault)
+	,mProxyID(AABBTree::NullNode)
+	,mSAPProxyID(SweepAndPrune::NullProxy)
+	,mBody(nullptr)
 {
-	mOwner->GetGame()->GetPhysWorld()->AddBox(this);
+	mPhysHandle = mOwner->GetGame()->GetPhysWorld()->AddBox(this);
+	// If the owner already has a body without a box, this is its box
+	RigidBodyComponent* body = static_cast<RigidBodyComponent*>(
+		mOwner->GetComponentOfType(TRigidBodyComponent));
+	if (body && !body->GetBox())
+	{
+		mBody = body;
+		body->SetBox(this);
+	}
 }
 
 BoxComponent::~BoxComponent()
 {
-	mOwner->GetGame()->GetPhysWorld()->RemoveBox(this);
+	mOwner->GetGame()->GetPhysWorld()->RemoveBox(mPhysHandle);
+	if (mBody)
+	{
+		mBody->SetBox(nullptr);
+	}
+}
+
+void BoxComponent::SetLayer(uint32_t layer)
+{
+	mLayer = layer;
+	// Cached casts may have matched (or skipped) the old layer
+	mOwner->GetGame()->GetPhysWorld()->InvalidateQueryCache();
 }
 
 void BoxComponent::OnUpdateWorldTransform()
@@ -31,16 +58,37 @@ void BoxComponent::OnUpdateWorldTransform()
 	// Reset to object space box
 	mWorldBox = mObjectBox;
 	// Scale
-	mWorldBox.mMin *= mOwner->GetScale();
-	mWorldBox.mMax *= mOwner->GetScale();
+	float scale = mOwner->GetWorldScale();
+	mWorldBox.mMin *= scale;
+	mWorldBox.mMax *= scale;
 	// Rotate (if we want to)
+	Quaternion rotation = Quaternion::Identity;
 	if (mShouldRotate)
 	{
-		mWorldBox.Rotate(mOwner->GetRotation());
+		rotation = mOwner->GetWorldRotation();
+		mWorldBox.Rotate(rotation);
 	}
 	// Translate
-	mWorldBox.mMin += mOwner->GetPosition();
-	mWorldBox.mMax += mOwner->GetPosition();
+	Vector3 pos = mOwner->GetWorldPosition();
+	mWorldBox.mMin += pos;
+	mWorldBox.mMax += pos;
+
+	// The OBB is the scaled object box, rotated about the owner
+	Vector3 center = (mObjectBox.mMin + mObjectBox.mMax) * (0.5f * scale);
+	mWorldOBB.mCenter = Vector3::Transform(center, rotation) + pos;
+	mWorldOBB.mRotation = rotation;
+	mWorldOBB.mExtents = (mObjectBox.mMax - mObjectBox.mMin) * (0.5f * scale);
+	// (any rotation that isn't close to none)
+	mIsRotated = Math::Abs(rotation.w) < 0.99999f;
+
+	// This can run on a job thread, so the tree is refit later
+	// (when the command buffer executes, on the main thread)
+	Game* game = mOwner->GetGame();
+	PhysWorld* phys = game->GetPhysWorld();
+	SlotHandle handle = mPhysHandle;
+	game->GetCommandBuffer()->Push([phys, handle]() {
+		phys->UpdateBox(handle);
+	});
 }
 
 void BoxComponent::LoadProperties(const rapidjson::Value& inObj)
@@ -52,6 +100,11 @@ void BoxComponent::LoadProperties(const rapidjson::Value& inObj)
 	JsonHelper::GetVector3(inObj, "worldMin", mWorldBox.mMin);
 	JsonHelper::GetVector3(inObj, "worldMax", mWorldBox.mMax);
 	JsonHelper::GetBool(inObj, "shouldRotate", mShouldRotate);
+	int layer = static_cast<int>(mLayer);
+	if (JsonHelper::GetInt(inObj, "layer", layer))
+	{
+		SetLayer(static_cast<uint32_t>(layer));
+	}
 }
 
 void BoxComponent::SaveProperties(rapidjson::Document::AllocatorType & alloc, rapidjson::Value & inObj) const
@@ -63,4 +116,5 @@ void BoxComponent::SaveProperties(rapidjson::Document::AllocatorType & alloc, ra
 	JsonHelper::AddVector3(alloc, inObj, "worldMin", mWorldBox.mMin);
 	JsonHelper::AddVector3(alloc, inObj, "worldMax", mWorldBox.mMax);
 	JsonHelper::AddBool(alloc, inObj, "shouldRotate", mShouldRotate);
+	JsonHelper::AddInt(alloc, inObj, "layer", static_cast<int>(mLayer));
 }
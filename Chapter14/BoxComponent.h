@@ -9,6 +9,7 @@
 #pragma once
 #include "Component.h"
 #include "Collision.h"
+#include "SlotMap.h"
 
 class BoxComponent : public Component
 {
@@ -19,7 +20,16 @@ public:
 	void OnUpdateWorldTransform() override;
 
 	void SetObjectBox(const AABB& model) { mObjectBox = model; }
+	// Axis-aligned bounds (for the broadphase)
 	const AABB& GetWorldBox() const { return mWorldBox; }
+	// The object box rotated with the owner (a tight fit, unlike the
+	// world box, which grows to hold the rotated box)
+	const OBB& GetWorldOBB() const { return mWorldOBB; }
+	// If not, the world box and OBB are the same box
+	bool GetIsRotated() const { return mIsRotated; }
+	// Which PhysWorld::CollisionLayer it's on
+	uint32_t GetLayer() const { return mLayer; }
+	void SetLayer(uint32_t layer);
 
 	TypeID GetType() const override { return TBoxComponent; }
 
@@ -27,8 +37,26 @@ public:
 	void SaveProperties(rapidjson::Document::AllocatorType& alloc,
 		rapidjson::Value& inObj) const override;
 	void SetShouldRotate(bool value) { mShouldRotate = value; }
+
+	// Leaf in the physics world's box tree
+	int GetProxyID() const { return mProxyID; }
+	void SetProxyID(int id) { mProxyID = id; }
+	// Proxy in the physics world's sweep and prune
+	int GetSAPProxyID() const { return mSAPProxyID; }
+	void SetSAPProxyID(int id) { mSAPProxyID = id; }
+	// Body using this box (if any)
+	class RigidBodyComponent* GetRigidBody() const { return mBody; }
+	void SetRigidBody(class RigidBodyComponent* body) { mBody = body; }
 private:
 	AABB mObjectBox;
 	AABB mWorldBox;
+	OBB mWorldOBB;
 	bool mShouldRotate;
+	bool mIsRotated;
+	uint32_t mLayer;
+	// Handle in the physics world's boxes
+	SlotHandle mPhysHandle;
+	int mProxyID;
+	int mSAPProxyID;
+	class RigidBodyComponent* mBody;
 };
@@ -18,6 +18,19 @@
 #include <algorithm>
 #include <array>
 
+namespace
+{
+	float& Axis(Vector3& v, int axis)
+	{
+		return (&v.x)[axis];
+	}
+
+	float Axis(const Vector3& v, int axis)
+	{
+		return v.GetAsFloatPtr()[axis];
+	}
+}
+
 LineSegment::LineSegment(const Vector3& start, const Vector3& end)
 	:mStart(start)
 	,mEnd(end)
@@ -233,11 +246,47 @@ float AABB::MinDistSq(const Vector3& point) const
 	float dy = Math::Max(mMin.y - point.y, 0.0f);
 	dy = Math::Max(dy, point.y - mMax.y);
 	float dz = Math::Max(mMin.z - point.z, 0.0f);
-	dz = Math::Max(dy, point.z - mMax.z);
+	dz = Math::Max(dz, point.z - mMax.z);
 	// Distance squared formula
 	return dx * dx + dy * dy + dz * dz;
 }
 
+OBB::OBB(const Vector3& center, const Quaternion& rotation, const Vector3& extents)
+	:mCenter(center)
+	,mRotation(rotation)
+	,mExtents(extents)
+{
+}
+
+void OBB::GetAxes(Vector3 outAxes[3]) const
+{
+	outAxes[0] = Vector3::Transform(Vector3::UnitX, mRotation);
+	outAxes[1] = Vector3::Transform(Vector3::UnitY, mRotation);
+	outAxes[2] = Vector3::Transform(Vector3::UnitZ, mRotation);
+}
+
+Vector3 OBB::ToLocal(const Vector3& point) const
+{
+	Quaternion inverse = mRotation;
+	inverse.Conjugate();
+	return Vector3::Transform(point - mCenter, inverse);
+}
+
+Vector3 OBB::ToWorld(const Vector3& point) const
+{
+	return Vector3::Transform(point, mRotation) + mCenter;
+}
+
+AABB OBB::GetLocalBox() const
+{
+	return AABB(mExtents * -1.0f, mExtents);
+}
+
+bool OBB::Contains(const Vector3& point) const
+{
+	return GetLocalBox().Contains(ToLocal(point));
+}
+
 Capsule::Capsule(const Vector3& start, const Vector3& end, float radius)
 	:mSegment(start, end)
 	, mRadius(radius)
@@ -256,6 +305,26 @@ bool Capsule::Contains(const Vector3& point) const
 	return distSq <= (mRadius * mRadius);
 }
 
+Frustum::Frustum(const Matrix4& viewProj)
+{
+	// Each plane is the w column plus or minus the x, y or z column
+	// (a point is inside when -w <= x, y, z <= w in clip space)
+	mPlanes.reserve(6);
+	for (int col = 0; col < 3; col++)
+	{
+		for (float sign = 1.0f; sign >= -1.0f; sign -= 2.0f)
+		{
+			Vector3 normal(viewProj.mat[0][3] + sign * viewProj.mat[0][col],
+				viewProj.mat[1][3] + sign * viewProj.mat[1][col],
+				viewProj.mat[2][3] + sign * viewProj.mat[2][col]);
+			float d = viewProj.mat[3][3] + sign * viewProj.mat[3][col];
+			// Normalize, so signed distances are in world units
+			float invLength = 1.0f / normal.Length();
+			mPlanes.emplace_back(normal * invLength, -d * invLength);
+		}
+	}
+}
+
 bool ConvexPolygon::Contains(const Vector2& point) const
 {
 	float sum = 0.0f;
@@ -314,6 +383,108 @@ bool Intersect(const Sphere& s, const AABB& box)
 	return distSq <= (s.mRadius * s.mRadius);
 }
 
+bool Intersect(const OBB& a, const OBB& b)
+{
+	// Separating axis test (from Real-Time Collision Detection,
+	// Ericson 4.4.1), done in a's space
+	Vector3 axesA[3];
+	Vector3 axesB[3];
+	a.GetAxes(axesA);
+	b.GetAxes(axesB);
+	const float* ea = a.mExtents.GetAsFloatPtr();
+	const float* eb = b.mExtents.GetAsFloatPtr();
+
+	// Rotation from b to a, and b's center in a's space
+	float r[3][3];
+	float absR[3][3];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			r[i][j] = Vector3::Dot(axesA[i], axesB[j]);
+			// Epsilon so parallel edges' cross products don't cause trouble
+			absR[i][j] = Math::Abs(r[i][j]) + 0.0001f;
+		}
+	}
+	Vector3 diff = b.mCenter - a.mCenter;
+	float t[3] = { Vector3::Dot(diff, axesA[0]), Vector3::Dot(diff, axesA[1]),
+		Vector3::Dot(diff, axesA[2]) };
+
+	// a's face axes
+	for (int i = 0; i < 3; i++)
+	{
+		float rb = eb[0] * absR[i][0] + eb[1] * absR[i][1] + eb[2] * absR[i][2];
+		if (Math::Abs(t[i]) > ea[i] + rb)
+		{
+			return false;
+		}
+	}
+	// b's face axes
+	for (int j = 0; j < 3; j++)
+	{
+		float ra = ea[0] * absR[0][j] + ea[1] * absR[1][j] + ea[2] * absR[2][j];
+		float dist = t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j];
+		if (Math::Abs(dist) > ra + eb[j])
+		{
+			return false;
+		}
+	}
+	// Cross products of each pair of edges
+	for (int i = 0; i < 3; i++)
+	{
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; j++)
+		{
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+			float ra = ea[i1] * absR[i2][j] + ea[i2] * absR[i1][j];
+			float rb = eb[j1] * absR[i][j2] + eb[j2] * absR[i][j1];
+			float dist = t[i2] * r[i1][j] - t[i1] * r[i2][j];
+			if (Math::Abs(dist) > ra + rb)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool Intersect(const Sphere& s, const OBB& box)
+{
+	return Intersect(Sphere(box.ToLocal(s.mCenter), s.mRadius), box.GetLocalBox());
+}
+
+bool Intersect(const Frustum& f, const Sphere& s)
+{
+	for (const Plane& p : f.mPlanes)
+	{
+		if (p.SignedDist(s.mCenter) < -s.mRadius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Intersect(const Frustum& f, const AABB& box)
+{
+	// Only outside if the corner furthest along a plane's normal is
+	// behind it (this can miss boxes near the frustum's corners, but
+	// never culls a visible one)
+	for (const Plane& p : f.mPlanes)
+	{
+		Vector3 corner(p.mNormal.x >= 0.0f ? box.mMax.x : box.mMin.x,
+			p.mNormal.y >= 0.0f ? box.mMax.y : box.mMin.y,
+			p.mNormal.z >= 0.0f ? box.mMax.z : box.mMin.z);
+		if (p.SignedDist(corner) < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 bool Intersect(const LineSegment& l, const Sphere& s, float& outT)
 {
 	// Compute X, Y, a, b, c as per equations
@@ -457,6 +628,74 @@ bool Intersect(const LineSegment& l, const AABB& b, float& outT,
 	return false;
 }
 
+bool Intersect(const LineSegment& l, const OBB& b, float& outT,
+	Vector3& outNorm)
+{
+	// Slab test in the box's space, where it's centered at the origin.
+	// Like the AABB test, the hit is where it enters the box, or where
+	// it leaves if it starts inside.
+	Vector3 start = b.ToLocal(l.mStart);
+	Vector3 dir = b.ToLocal(l.mEnd) - start;
+	float tEnter = -Math::Infinity;
+	float tExit = Math::Infinity;
+	int enterAxis = -1;
+	int exitAxis = -1;
+	for (int a = 0; a < 3; a++)
+	{
+		float s = Axis(start, a);
+		float d = Axis(dir, a);
+		float e = Axis(b.mExtents, a);
+		if (Math::NearZero(d))
+		{
+			// Parallel to this slab, so it has to start within it
+			if (s < -e || s > e)
+			{
+				return false;
+			}
+			continue;
+		}
+		float t1 = (-e - s) / d;
+		float t2 = (e - s) / d;
+		if (t1 > t2)
+		{
+			std::swap(t1, t2);
+		}
+		if (t1 > tEnter)
+		{
+			tEnter = t1;
+			enterAxis = a;
+		}
+		if (t2 < tExit)
+		{
+			tExit = t2;
+			exitAxis = a;
+		}
+	}
+	if (tEnter > tExit)
+	{
+		return false;
+	}
+
+	// Normal of the side crossed (entering moves against it)
+	Vector3 norm = Vector3::Zero;
+	if (tEnter >= 0.0f && tEnter <= 1.0f)
+	{
+		outT = tEnter;
+		Axis(norm, enterAxis) = Axis(dir, enterAxis) > 0.0f ? -1.0f : 1.0f;
+	}
+	else if (tEnter < 0.0f && exitAxis >= 0 && tExit >= 0.0f && tExit <= 1.0f)
+	{
+		outT = tExit;
+		Axis(norm, exitAxis) = Axis(dir, exitAxis) > 0.0f ? 1.0f : -1.0f;
+	}
+	else
+	{
+		return false;
+	}
+	outNorm = Vector3::Transform(norm, b.mRotation);
+	return true;
+}
+
 bool SweptSphere(const Sphere& P0, const Sphere& P1,
 	const Sphere& Q0, const Sphere& Q1, float& outT)
 {
@@ -468,6 +707,11 @@ bool SweptSphere(const Sphere& P0, const Sphere& P1,
 	float b = 2.0f * Vector3::Dot(X, Y);
 	float sumRadii = P0.mRadius + Q0.mRadius;
 	float c = Vector3::Dot(X, X) - sumRadii * sumRadii;
+	// No relative motion, so they never start touching
+	if (Math::NearZero(a))
+	{
+		return false;
+	}
 	// Solve discriminant
 	float disc = b * b - 4.0f * a * c;
 	if (disc < 0.0f)
@@ -479,7 +723,7 @@ bool SweptSphere(const Sphere& P0, const Sphere& P1,
 		disc = Math::Sqrt(disc);
 		// We only care about the smaller solution
 		outT = (-b - disc) / (2.0f * a);
-		if (outT >= 0.0f && outT <= 0.0f)
+		if (outT >= 0.0f && outT <= 1.0f)
 		{
 			return true;
 		}
@@ -489,3 +733,679 @@ bool SweptSphere(const Sphere& P0, const Sphere& P1,
 		}
 	}
 }
+
+namespace
+{
+	// Sphere moving from start to end against the rounded edge of a box,
+	// which runs along axis through point q (from lo to hi on that axis)
+	bool SweptEdge(const Vector3& start, const Vector3& end, float radius,
+		const Vector3& q, int axis, float lo, float hi, float& outT)
+	{
+		// Ignoring the edge's axis, it's a circle hitting a point
+		Vector3 p0 = start;
+		Vector3 p1 = end;
+		Vector3 e = q;
+		Axis(p0, axis) = 0.0f;
+		Axis(p1, axis) = 0.0f;
+		Axis(e, axis) = 0.0f;
+		float t;
+		if (SweptSphere(Sphere(p0, radius), Sphere(p1, radius),
+			Sphere(e, 0.0f), Sphere(e, 0.0f), t))
+		{
+			// Only hits the edge if it's between the corners
+			float along = Math::Lerp(Axis(start, axis), Axis(end, axis), t);
+			if (along >= lo && along <= hi)
+			{
+				outT = t;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Vector3 ClosestPoint(const AABB& b, const Vector3& p)
+	{
+		return Vector3(Math::Clamp(p.x, b.mMin.x, b.mMax.x),
+			Math::Clamp(p.y, b.mMin.y, b.mMax.y),
+			Math::Clamp(p.z, b.mMin.z, b.mMax.z));
+	}
+}
+
+bool SweptSphere(const Sphere& s, const Vector3& end, const AABB& b,
+	float& outT, Vector3& outNorm)
+{
+	const Vector3& start = s.mCenter;
+	float r = s.mRadius;
+	Vector3 move = end - start;
+
+	// Already touching at the start?
+	if (b.MinDistSq(start) <= r * r)
+	{
+		outNorm = start - ClosestPoint(b, start);
+		if (Math::NearZero(outNorm.LengthSq()))
+		{
+			// Center's inside the box, so push back the way it came
+			outNorm = move * -1.0f;
+		}
+		// Only a hit if it's moving further in
+		if (Math::NearZero(outNorm.LengthSq()) ||
+			Vector3::Dot(move, outNorm) >= 0.0f)
+		{
+			return false;
+		}
+		outNorm.Normalize();
+		outT = 0.0f;
+		return true;
+	}
+
+	// The center hits the box grown by the radius, with rounded edges
+	// and corners. First slab test against it with sharp ones.
+	AABB grown(b.mMin - Vector3(r, r, r), b.mMax + Vector3(r, r, r));
+	float tEnter = 0.0f;
+	float tExit = 1.0f;
+	int enterAxis = 0;
+	for (int a = 0; a < 3; a++)
+	{
+		float d = Axis(move, a);
+		float p = Axis(start, a);
+		if (Math::NearZero(d))
+		{
+			if (p < Axis(grown.mMin, a) || p > Axis(grown.mMax, a))
+			{
+				return false;
+			}
+			continue;
+		}
+		float t1 = (Axis(grown.mMin, a) - p) / d;
+		float t2 = (Axis(grown.mMax, a) - p) / d;
+		if (Math::Min(t1, t2) > tEnter)
+		{
+			tEnter = Math::Min(t1, t2);
+			enterAxis = a;
+		}
+		tExit = Math::Min(tExit, Math::Max(t1, t2));
+		if (tEnter > tExit)
+		{
+			return false;
+		}
+	}
+
+	// Which part of the rounded box is that point next to?
+	Vector3 point = start + move * tEnter;
+	int numOutside = 0;
+	for (int a = 0; a < 3; a++)
+	{
+		if (Axis(point, a) < Axis(b.mMin, a) || Axis(point, a) > Axis(b.mMax, a))
+		{
+			numOutside++;
+		}
+	}
+
+	if (numOutside <= 1)
+	{
+		// A face, so the sharp box was right
+		outT = tEnter;
+		outNorm = Vector3::Zero;
+		Axis(outNorm, enterAxis) = Axis(move, enterAxis) > 0.0f ? -1.0f : 1.0f;
+		return true;
+	}
+
+	// Otherwise it's near an edge or corner, and might pass by them.
+	// The first of the rounded edges and corners it hits is the hit.
+	bool hit = false;
+	float t;
+	for (int i = 0; i < 8; i++)
+	{
+		Vector3 corner((i & 1) ? b.mMax.x : b.mMin.x,
+			(i & 2) ? b.mMax.y : b.mMin.y,
+			(i & 4) ? b.mMax.z : b.mMin.z);
+		if (SweptSphere(Sphere(start, r), Sphere(end, r),
+			Sphere(corner, 0.0f), Sphere(corner, 0.0f), t) && (!hit || t < outT))
+		{
+			outT = t;
+			hit = true;
+		}
+		// The three edges from this corner that go toward max
+		for (int a = 0; a < 3; a++)
+		{
+			if (!(i & (1 << a)) && SweptEdge(start, end, r, corner, a,
+				Axis(b.mMin, a), Axis(b.mMax, a), t) && (!hit || t < outT))
+			{
+				outT = t;
+				hit = true;
+			}
+		}
+	}
+
+	if (hit)
+	{
+		Vector3 center = start + move * outT;
+		outNorm = center - ClosestPoint(b, center);
+		outNorm.Normalize();
+	}
+	return hit;
+}
+
+bool SweptSphere(const Sphere& s, const Vector3& end, const OBB& b,
+	float& outT, Vector3& outNorm)
+{
+	// Sweep in the box's space, where it's an AABB
+	Sphere local(b.ToLocal(s.mCenter), s.mRadius);
+	if (SweptSphere(local, b.ToLocal(end), b.GetLocalBox(), outT, outNorm))
+	{
+		outNorm = Vector3::Transform(outNorm, b.mRotation);
+		return true;
+	}
+	return false;
+}
+
+namespace
+{
+	// Closest points between two segments (from Real-Time Collision
+	// Detection, Ericson 5.1.9)
+	void ClosestPoints(const LineSegment& s1, const LineSegment& s2,
+		Vector3& outP1, Vector3& outP2)
+	{
+		Vector3 d1 = s1.mEnd - s1.mStart;
+		Vector3 d2 = s2.mEnd - s2.mStart;
+		Vector3 r = s1.mStart - s2.mStart;
+		float a = Vector3::Dot(d1, d1);
+		float e = Vector3::Dot(d2, d2);
+		float f = Vector3::Dot(d2, r);
+		float s = 0.0f;
+		float t = 0.0f;
+		if (Math::NearZero(a) && Math::NearZero(e))
+		{
+			// Both are points
+		}
+		else if (Math::NearZero(a))
+		{
+			t = Math::Clamp(f / e, 0.0f, 1.0f);
+		}
+		else
+		{
+			float c = Vector3::Dot(d1, r);
+			if (Math::NearZero(e))
+			{
+				s = Math::Clamp(-c / a, 0.0f, 1.0f);
+			}
+			else
+			{
+				float b = Vector3::Dot(d1, d2);
+				float denom = a * e - b * b;
+				// Parallel segments can use any s
+				if (!Math::NearZero(denom))
+				{
+					s = Math::Clamp((b * f - c * e) / denom, 0.0f, 1.0f);
+				}
+				t = (b * s + f) / e;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = Math::Clamp(-c / a, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = Math::Clamp((b - c) / a, 0.0f, 1.0f);
+				}
+			}
+		}
+		outP1 = s1.mStart + d1 * s;
+		outP2 = s2.mStart + d2 * t;
+	}
+
+	Vector3 ClosestPoint(const LineSegment& l, const Vector3& p)
+	{
+		Vector3 d = l.mEnd - l.mStart;
+		float lenSq = d.LengthSq();
+		if (Math::NearZero(lenSq))
+		{
+			return l.mStart;
+		}
+		float t = Math::Clamp(Vector3::Dot(p - l.mStart, d) / lenSq, 0.0f, 1.0f);
+		return l.mStart + d * t;
+	}
+
+	void SetSinglePoint(ContactManifold& m, const Vector3& normal,
+		const Vector3& point, float depth)
+	{
+		m.mNormal = normal;
+		m.mPoints[0] = point;
+		m.mDepths[0] = depth;
+		m.mNumPoints = 1;
+	}
+
+	// Move a manifold found in the box's space back to world space
+	void ManifoldToWorld(const OBB& b, ContactManifold& m)
+	{
+		m.mNormal = Vector3::Transform(m.mNormal, b.mRotation);
+		for (int i = 0; i < m.mNumPoints; i++)
+		{
+			m.mPoints[i] = b.ToWorld(m.mPoints[i]);
+		}
+	}
+
+	// Half the box's length along axis
+	float ProjectedRadius(const Vector3 axes[3], const float* extents,
+		const Vector3& axis)
+	{
+		return extents[0] * Math::Abs(Vector3::Dot(axes[0], axis)) +
+			extents[1] * Math::Abs(Vector3::Dot(axes[1], axis)) +
+			extents[2] * Math::Abs(Vector3::Dot(axes[2], axis));
+	}
+
+	// Keep the part of the polygon where dot(p, n) <= d
+	// (returns the new number of points, at most one more than before)
+	int ClipPolygon(const Vector3* in, int numIn, const Vector3& n, float d,
+		Vector3* out)
+	{
+		int numOut = 0;
+		for (int i = 0; i < numIn; i++)
+		{
+			const Vector3& p0 = in[i];
+			const Vector3& p1 = in[(i + 1) % numIn];
+			float d0 = Vector3::Dot(p0, n) - d;
+			float d1 = Vector3::Dot(p1, n) - d;
+			if (d0 <= 0.0f)
+			{
+				out[numOut++] = p0;
+			}
+			// Edge crosses the plane
+			if (d0 * d1 < 0.0f)
+			{
+				out[numOut++] = Vector3::Lerp(p0, p1, d0 / (d0 - d1));
+			}
+		}
+		return numOut;
+	}
+
+	// Pick up to 4 of the points: the deepest, the one farthest from it,
+	// and the ones making the biggest triangles with those two (on each
+	// side), which keeps most of the contact area
+	void ReducePoints(const Vector3* points, const float* depths, int num,
+		const Vector3& normal, ContactManifold& m)
+	{
+		if (num <= ContactManifold::MaxPoints)
+		{
+			for (int i = 0; i < num; i++)
+			{
+				m.mPoints[i] = points[i];
+				m.mDepths[i] = depths[i];
+			}
+			m.mNumPoints = num;
+			return;
+		}
+
+		int first = 0;
+		for (int i = 1; i < num; i++)
+		{
+			if (depths[i] > depths[first])
+			{
+				first = i;
+			}
+		}
+		int second = first == 0 ? 1 : 0;
+		for (int i = 0; i < num; i++)
+		{
+			if ((points[i] - points[first]).LengthSq() >
+				(points[second] - points[first]).LengthSq())
+			{
+				second = i;
+			}
+		}
+		int third = -1;
+		int fourth = -1;
+		float maxArea = 0.0f;
+		float minArea = 0.0f;
+		Vector3 edge = points[second] - points[first];
+		for (int i = 0; i < num; i++)
+		{
+			float area = Vector3::Dot(Vector3::Cross(edge, points[i] - points[first]), normal);
+			if (area > maxArea)
+			{
+				maxArea = area;
+				third = i;
+			}
+			else if (area < minArea)
+			{
+				minArea = area;
+				fourth = i;
+			}
+		}
+
+		int picked[4] = { first, second, third, fourth };
+		m.mNumPoints = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			if (picked[i] >= 0)
+			{
+				m.mPoints[m.mNumPoints] = points[picked[i]];
+				m.mDepths[m.mNumPoints] = depths[picked[i]];
+				m.mNumPoints++;
+			}
+		}
+	}
+}
+
+bool Collide(const AABB& a, const AABB& b, ContactManifold& m)
+{
+	// Overlapping region
+	Vector3 overlapMin(Math::Max(a.mMin.x, b.mMin.x),
+		Math::Max(a.mMin.y, b.mMin.y), Math::Max(a.mMin.z, b.mMin.z));
+	Vector3 overlapMax(Math::Min(a.mMax.x, b.mMax.x),
+		Math::Min(a.mMax.y, b.mMax.y), Math::Min(a.mMax.z, b.mMax.z));
+	Vector3 overlap = overlapMax - overlapMin;
+	if (overlap.x < 0.0f || overlap.y < 0.0f || overlap.z < 0.0f)
+	{
+		return false;
+	}
+
+	// Push apart on the axis with the least overlap
+	int axis = 0;
+	for (int i = 1; i < 3; i++)
+	{
+		if (Axis(overlap, i) < Axis(overlap, axis))
+		{
+			axis = i;
+		}
+	}
+	float centerA = Axis(a.mMin, axis) + Axis(a.mMax, axis);
+	float centerB = Axis(b.mMin, axis) + Axis(b.mMax, axis);
+	m.mNormal = Vector3::Zero;
+	Axis(m.mNormal, axis) = centerA < centerB ? 1.0f : -1.0f;
+
+	// The corners of the overlap, halfway through it on that axis
+	int u = (axis + 1) % 3;
+	int v = (axis + 2) % 3;
+	float mid = (Axis(overlapMin, axis) + Axis(overlapMax, axis)) * 0.5f;
+	m.mNumPoints = 4;
+	for (int i = 0; i < 4; i++)
+	{
+		Vector3& p = m.mPoints[i];
+		Axis(p, axis) = mid;
+		Axis(p, u) = (i & 1) ? Axis(overlapMax, u) : Axis(overlapMin, u);
+		Axis(p, v) = (i & 2) ? Axis(overlapMax, v) : Axis(overlapMin, v);
+		m.mDepths[i] = Axis(overlap, axis);
+	}
+	return true;
+}
+
+bool Collide(const Sphere& a, const AABB& b, ContactManifold& m)
+{
+	Vector3 closest = ClosestPoint(b, a.mCenter);
+	Vector3 diff = closest - a.mCenter;
+	float distSq = diff.LengthSq();
+	if (distSq > a.mRadius * a.mRadius)
+	{
+		return false;
+	}
+
+	if (!Math::NearZero(distSq))
+	{
+		float dist = Math::Sqrt(distSq);
+		SetSinglePoint(m, diff * (1.0f / dist), closest, a.mRadius - dist);
+		return true;
+	}
+
+	// The center is inside the box, so push out the nearest face
+	Vector3 toMin = a.mCenter - b.mMin;
+	Vector3 toMax = b.mMax - a.mCenter;
+	int axis = 0;
+	float faceDist = toMin.x;
+	float sign = 1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		if (Axis(toMin, i) < faceDist)
+		{
+			faceDist = Axis(toMin, i);
+			axis = i;
+			sign = 1.0f;
+		}
+		if (Axis(toMax, i) < faceDist)
+		{
+			faceDist = Axis(toMax, i);
+			axis = i;
+			sign = -1.0f;
+		}
+	}
+	Vector3 normal = Vector3::Zero;
+	Axis(normal, axis) = sign;
+	SetSinglePoint(m, normal, a.mCenter, a.mRadius + faceDist);
+	return true;
+}
+
+bool Collide(const Sphere& a, const Sphere& b, ContactManifold& m)
+{
+	Vector3 diff = b.mCenter - a.mCenter;
+	float sumRadii = a.mRadius + b.mRadius;
+	float distSq = diff.LengthSq();
+	if (distSq > sumRadii * sumRadii)
+	{
+		return false;
+	}
+
+	float dist = Math::Sqrt(distSq);
+	// Exactly on top of each other, so pick a direction
+	Vector3 normal = Math::NearZero(dist) ? Vector3::UnitZ : diff * (1.0f / dist);
+	SetSinglePoint(m, normal, a.mCenter + normal * a.mRadius, sumRadii - dist);
+	return true;
+}
+
+bool Collide(const Capsule& a, const AABB& b, ContactManifold& m)
+{
+	// Distance to the box is convex along the segment, so narrow in on
+	// the closest point, and then it's a sphere there against the box
+	float lo = 0.0f;
+	float hi = 1.0f;
+	for (int i = 0; i < 24; i++)
+	{
+		float t1 = lo + (hi - lo) / 3.0f;
+		float t2 = hi - (hi - lo) / 3.0f;
+		if (b.MinDistSq(a.PointOnSegment(t1)) < b.MinDistSq(a.PointOnSegment(t2)))
+		{
+			hi = t2;
+		}
+		else
+		{
+			lo = t1;
+		}
+	}
+	return Collide(Sphere(a.PointOnSegment((lo + hi) * 0.5f), a.mRadius), b, m);
+}
+
+bool Collide(const Capsule& a, const Sphere& b, ContactManifold& m)
+{
+	Vector3 closest = ClosestPoint(a.mSegment, b.mCenter);
+	return Collide(Sphere(closest, a.mRadius), b, m);
+}
+
+bool Collide(const Capsule& a, const Capsule& b, ContactManifold& m)
+{
+	Vector3 pa;
+	Vector3 pb;
+	ClosestPoints(a.mSegment, b.mSegment, pa, pb);
+	return Collide(Sphere(pa, a.mRadius), Sphere(pb, b.mRadius), m);
+}
+
+bool Collide(const OBB& a, const OBB& b, ContactManifold& m)
+{
+	Vector3 axesA[3];
+	Vector3 axesB[3];
+	a.GetAxes(axesA);
+	b.GetAxes(axesB);
+	const float* ea = a.mExtents.GetAsFloatPtr();
+	const float* eb = b.mExtents.GetAsFloatPtr();
+	Vector3 diff = b.mCenter - a.mCenter;
+
+	// Find the separating axis test's axis with the least overlap:
+	// 0-2 are a's faces, 3-5 are b's faces, and 6-14 are edge pairs
+	int minAxis = -1;
+	float minOverlap = 0.0f;
+	float minBiased = Math::Infinity;
+	Vector3 normal;
+	for (int i = 0; i < 15; i++)
+	{
+		Vector3 axis;
+		if (i < 3)
+		{
+			axis = axesA[i];
+		}
+		else if (i < 6)
+		{
+			axis = axesB[i - 3];
+		}
+		else
+		{
+			axis = Vector3::Cross(axesA[(i - 6) / 3], axesB[(i - 6) % 3]);
+			float lenSq = axis.LengthSq();
+			// Parallel edges are already covered by the face axes
+			if (lenSq < 0.0001f)
+			{
+				continue;
+			}
+			axis *= 1.0f / Math::Sqrt(lenSq);
+		}
+
+		float dist = Vector3::Dot(diff, axis);
+		float overlap = ProjectedRadius(axesA, ea, axis) +
+			ProjectedRadius(axesB, eb, axis) - Math::Abs(dist);
+		if (overlap < 0.0f)
+		{
+			return false;
+		}
+		// Faces give steadier contacts, so edges have to be clearly better
+		float biased = i < 6 ? overlap : overlap * 1.05f;
+		if (biased < minBiased)
+		{
+			minBiased = biased;
+			minOverlap = overlap;
+			minAxis = i;
+			normal = dist < 0.0f ? axis * -1.0f : axis;
+		}
+	}
+
+	if (minAxis >= 6)
+	{
+		// Edge against edge, so one point between the closest edges
+		int i = (minAxis - 6) / 3;
+		int j = (minAxis - 6) % 3;
+		Vector3 edgeA = a.mCenter;
+		Vector3 edgeB = b.mCenter;
+		for (int k = 0; k < 3; k++)
+		{
+			if (k != i)
+			{
+				float side = Vector3::Dot(axesA[k], normal) > 0.0f ? ea[k] : -ea[k];
+				edgeA += axesA[k] * side;
+			}
+			if (k != j)
+			{
+				float side = Vector3::Dot(axesB[k], normal) > 0.0f ? -eb[k] : eb[k];
+				edgeB += axesB[k] * side;
+			}
+		}
+		Vector3 pa;
+		Vector3 pb;
+		ClosestPoints(LineSegment(edgeA - axesA[i] * ea[i], edgeA + axesA[i] * ea[i]),
+			LineSegment(edgeB - axesB[j] * eb[j], edgeB + axesB[j] * eb[j]), pa, pb);
+		SetSinglePoint(m, normal, (pa + pb) * 0.5f, minOverlap);
+		return true;
+	}
+
+	// Face contact: the reference face is on the box with that axis, and
+	// the incident face is the other box's face pointing most against it
+	bool refIsA = minAxis < 3;
+	const OBB& ref = refIsA ? a : b;
+	const OBB& inc = refIsA ? b : a;
+	const Vector3* refAxes = refIsA ? axesA : axesB;
+	const Vector3* incAxes = refIsA ? axesB : axesA;
+	const float* refExt = refIsA ? ea : eb;
+	const float* incExt = refIsA ? eb : ea;
+	int refIndex = minAxis % 3;
+	// Points from the reference box toward the incident box
+	Vector3 refNormal = refIsA ? normal : normal * -1.0f;
+
+	int incIndex = 0;
+	for (int k = 1; k < 3; k++)
+	{
+		if (Math::Abs(Vector3::Dot(incAxes[k], refNormal)) >
+			Math::Abs(Vector3::Dot(incAxes[incIndex], refNormal)))
+		{
+			incIndex = k;
+		}
+	}
+	float incSide = Vector3::Dot(incAxes[incIndex], refNormal) > 0.0f ?
+		-incExt[incIndex] : incExt[incIndex];
+	Vector3 faceCenter = inc.mCenter + incAxes[incIndex] * incSide;
+	Vector3 du = incAxes[(incIndex + 1) % 3] * incExt[(incIndex + 1) % 3];
+	Vector3 dv = incAxes[(incIndex + 2) % 3] * incExt[(incIndex + 2) % 3];
+
+	// Clip the incident face to the sides of the reference face
+	// (each clip adds at most one point, so 8 is enough)
+	Vector3 polyA[8] = { faceCenter + du + dv, faceCenter - du + dv,
+		faceCenter - du - dv, faceCenter + du - dv };
+	Vector3 polyB[8];
+	Vector3* poly = polyA;
+	Vector3* clipped = polyB;
+	int numPoints = 4;
+	for (int k = 1; k < 3 && numPoints > 0; k++)
+	{
+		int side = (refIndex + k) % 3;
+		for (int s = 0; s < 2 && numPoints > 0; s++)
+		{
+			Vector3 sideNormal = s == 0 ? refAxes[side] : refAxes[side] * -1.0f;
+			float d = Vector3::Dot(ref.mCenter, sideNormal) + refExt[side];
+			numPoints = ClipPolygon(poly, numPoints, sideNormal, d, clipped);
+			std::swap(poly, clipped);
+		}
+	}
+
+	// Keep the points below the reference face (halfway through it)
+	float faceDist = Vector3::Dot(ref.mCenter, refNormal) + refExt[refIndex];
+	Vector3 points[8];
+	float depths[8];
+	int numContacts = 0;
+	for (int k = 0; k < numPoints; k++)
+	{
+		float depth = faceDist - Vector3::Dot(poly[k], refNormal);
+		if (depth >= 0.0f)
+		{
+			points[numContacts] = poly[k] + refNormal * (depth * 0.5f);
+			depths[numContacts] = depth;
+			numContacts++;
+		}
+	}
+
+	m.mNormal = normal;
+	if (numContacts == 0)
+	{
+		// Only just touching (lost to rounding), so use the face center
+		SetSinglePoint(m, normal, faceCenter, minOverlap);
+		return true;
+	}
+	ReducePoints(points, depths, numContacts, refNormal, m);
+	return true;
+}
+
+bool Collide(const Sphere& a, const OBB& b, ContactManifold& m)
+{
+	// Collide in the box's space, where it's an AABB
+	if (Collide(Sphere(b.ToLocal(a.mCenter), a.mRadius), b.GetLocalBox(), m))
+	{
+		ManifoldToWorld(b, m);
+		return true;
+	}
+	return false;
+}
+
+bool Collide(const Capsule& a, const OBB& b, ContactManifold& m)
+{
+	Capsule local(b.ToLocal(a.mSegment.mStart), b.ToLocal(a.mSegment.mEnd), a.mRadius);
+	if (Collide(local, b.GetLocalBox(), m))
+	{
+		ManifoldToWorld(b, m);
+		return true;
+	}
+	return false;
+}
@@ -62,8 +62,20 @@ struct AABB
 
 struct OBB
 {
+	OBB(const Vector3& center, const Quaternion& rotation, const Vector3& extents);
+	// Unit vectors along the box's x, y, and z
+	void GetAxes(Vector3 outAxes[3]) const;
+	// Point relative to the box (as if it were centered at the origin,
+	// with no rotation), and back
+	Vector3 ToLocal(const Vector3& point) const;
+	Vector3 ToWorld(const Vector3& point) const;
+	// The box in its own space
+	AABB GetLocalBox() const;
+	bool Contains(const Vector3& point) const;
+
 	Vector3 mCenter;
 	Quaternion mRotation;
+	// Half the size on each axis
 	Vector3 mExtents;
 };
 
@@ -78,6 +90,17 @@ struct Capsule
 	float mRadius;
 };
 
+// View frustum as six planes whose normals point inside
+struct Frustum
+{
+	// Extract the planes from a view * projection matrix
+	// (so they're in world space)
+	Frustum(const Matrix4& viewProj);
+
+	// Left, right, bottom, top, near, far
+	std::vector<Plane> mPlanes;
+};
+
 struct ConvexPolygon
 {
 	bool Contains(const Vector2& point) const;
@@ -90,11 +113,46 @@ bool Intersect(const Sphere& a, const Sphere& b);
 bool Intersect(const AABB& a, const AABB& b);
 bool Intersect(const Capsule& a, const Capsule& b);
 bool Intersect(const Sphere& s, const AABB& box);
+bool Intersect(const OBB& a, const OBB& b);
+bool Intersect(const Sphere& s, const OBB& box);
+// True if any of the shape might be inside the frustum
+bool Intersect(const Frustum& f, const Sphere& s);
+bool Intersect(const Frustum& f, const AABB& box);
 
 bool Intersect(const LineSegment& l, const Sphere& s, float& outT);
 bool Intersect(const LineSegment& l, const Plane& p, float& outT);
 bool Intersect(const LineSegment& l, const AABB& b, float& outT,
 	Vector3& outNorm);
+bool Intersect(const LineSegment& l, const OBB& b, float& outT,
+	Vector3& outNorm);
 
 bool SweptSphere(const Sphere& P0, const Sphere& P1,
 	const Sphere& Q0, const Sphere& Q1, float& t);
+// Sphere moving to end, against a still box (t is the time of impact,
+// and the normal points out of the box at the contact)
+bool SweptSphere(const Sphere& s, const Vector3& end, const AABB& b,
+	float& outT, Vector3& outNorm);
+bool SweptSphere(const Sphere& s, const Vector3& end, const OBB& b,
+	float& outT, Vector3& outNorm);
+
+// Where two overlapping shapes touch (the normal points from the
+// first shape toward the second, and each point has its own depth)
+struct ContactManifold
+{
+	static const int MaxPoints = 4;
+	Vector3 mNormal;
+	Vector3 mPoints[MaxPoints];
+	float mDepths[MaxPoints];
+	int mNumPoints;
+};
+
+// Contact generation (returns false if they don't overlap)
+bool Collide(const AABB& a, const AABB& b, ContactManifold& m);
+bool Collide(const Sphere& a, const AABB& b, ContactManifold& m);
+bool Collide(const Sphere& a, const Sphere& b, ContactManifold& m);
+bool Collide(const Capsule& a, const AABB& b, ContactManifold& m);
+bool Collide(const Capsule& a, const Sphere& b, ContactManifold& m);
+bool Collide(const Capsule& a, const Capsule& b, ContactManifold& m);
+bool Collide(const OBB& a, const OBB& b, ContactManifold& m);
+bool Collide(const Sphere& a, const OBB& b, ContactManifold& m);
+bool Collide(const Capsule& a, const OBB& b, ContactManifold& m);
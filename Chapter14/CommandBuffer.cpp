@@ -0,0 +1,63 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "CommandBuffer.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+thread_local uint64_t CommandBuffer::sSortKey = 0;
+
+CommandBuffer::CommandBuffer(int numThreads)
+	:mThreadCommands(numThreads > 0 ? numThreads : 1)
+{
+}
+
+void CommandBuffer::Push(Command command)
+{
+	std::vector<Entry>& commands = mThreadCommands[JobSystem::GetThreadIndex()];
+	commands.emplace_back(Entry{ sSortKey, std::move(command) });
+}
+
+void CommandBuffer::SetActorState(Actor* actor, Actor::State state)
+{
+	Push([actor, state]() {
+		actor->SetState(state);
+	});
+}
+
+void CommandBuffer::Execute()
+{
+	for (auto& commands : mThreadCommands)
+	{
+		for (auto& entry : commands)
+		{
+			mMerged.emplace_back(std::move(entry));
+		}
+		commands.clear();
+	}
+	if (mMerged.empty())
+	{
+		return;
+	}
+
+	// Stable, so one item's commands keep the order they were pushed in
+	std::stable_sort(mMerged.begin(), mMerged.end(),
+		[](const Entry& a, const Entry& b) {
+			return a.mKey < b.mKey;
+		});
+
+	// (Commands may push more commands, which run next Execute)
+	std::vector<Entry> commands;
+	commands.swap(mMerged);
+	for (auto& entry : commands)
+	{
+		entry.mCommand();
+	}
+	commands.clear();
+	mMerged.swap(commands);
+}
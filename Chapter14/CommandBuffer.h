@@ -0,0 +1,50 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Actor.h"
+
+// Structural changes (spawning, killing, talking to the renderer or
+// audio...) that code running on job threads can't make directly.
+// Commands are queued per thread and run later on the main thread,
+// ordered by sort key, so the result doesn't depend on which thread
+// happened to run what.
+class CommandBuffer
+{
+public:
+	using Command = std::function<void()>;
+
+	CommandBuffer(int numThreads);
+
+	// Queue a command (safe from any job thread)
+	void Push(Command command);
+	// Common structural change: set an actor's state (like EDead)
+	void SetActorState(Actor* actor, Actor::State state);
+
+	// Run all queued commands in sort key order (main thread only)
+	void Execute();
+
+	// Sort key for commands pushed by the calling thread (set
+	// to something like the index of the item it's processing)
+	static void SetSortKey(uint64_t key) { sSortKey = key; }
+private:
+	struct Entry
+	{
+		uint64_t mKey;
+		Command mCommand;
+	};
+	// One list per thread, so pushing never contends
+	std::vector<std::vector<Entry>> mThreadCommands;
+	// Merged commands (kept around to reuse the memory)
+	std::vector<Entry> mMerged;
+
+	static thread_local uint64_t sSortKey;
+};
@@ -9,6 +9,9 @@
 #include "Component.h"
 #include "Actor.h"
 #include "LevelLoader.h"
+#include "Game.h"
+#include "ComponentRegistry.h"
+#include "ObjectPool.h"
 
 const char* Component::TypeNames[NUM_COMPONENT_TYPES] = {
 	"Component",
@@ -23,12 +26,15 @@ const char* Component::TypeNames[NUM_COMPONENT_TYPES] = {
 	"SpriteComponent",
 	"MirrorCamera",
 	"PointLightComponent",
-	"TargetComponent"
+	"TargetComponent",
+	"RigidBodyComponent"
 };
 
 Component::Component(Actor* owner, int updateOrder)
 	:mOwner(owner)
 	,mUpdateOrder(updateOrder)
+	,mBatch(nullptr)
+	,mBatchIndex(0)
 {
 	// Add to actor's vector of components
 	mOwner->AddComponent(this);
@@ -39,6 +45,16 @@ Component::~Component()
 	mOwner->RemoveComponent(this);
 }
 
+void* Component::operator new(size_t size)
+{
+	return ObjectAllocator::Allocate(size);
+}
+
+void Component::operator delete(void* ptr)
+{
+	ObjectAllocator::Free(ptr);
+}
+
 void Component::Update(float deltaTime)
 {
 }
@@ -49,7 +65,16 @@ void Component::OnUpdateWorldTransform()
 
 void Component::LoadProperties(const rapidjson::Value& inObj)
 {
-	JsonHelper::GetInt(inObj, "updateOrder", mUpdateOrder);
+	int updateOrder = mUpdateOrder;
+	JsonHelper::GetInt(inObj, "updateOrder", updateOrder);
+	if (updateOrder != mUpdateOrder)
+	{
+		// Moves to a different batch, so re-add to the registry
+		ComponentRegistry* registry = mOwner->GetGame()->GetComponentRegistry();
+		registry->RemoveComponent(this);
+		mUpdateOrder = updateOrder;
+		registry->AddComponent(this);
+	}
 }
 
 void Component::SaveProperties(rapidjson::Document::AllocatorType& alloc, rapidjson::Value& inObj) const
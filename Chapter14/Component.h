@@ -28,6 +28,7 @@ public:
 		TMirrorCamera,
 		TPointLightComponent,
 		TTargetComponent,
+		TRigidBodyComponent,
 
 		NUM_COMPONENT_TYPES
 	};
@@ -39,12 +40,21 @@ public:
 	Component(class Actor* owner, int updateOrder = 100);
 	// Destructor
 	virtual ~Component();
+
+	// Components are allocated through ObjectAllocator (pooled per size)
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
 	// Update this component by delta time
 	virtual void Update(float deltaTime);
 	// Process input for this component
 	virtual void ProcessInput(const uint8_t* keyState) {}
 	// Called when world transform changes
+	// (this can run on a job thread, so anything that touches shared
+	// state must go through the game's CommandBuffer)
 	virtual void OnUpdateWorldTransform();
+	// Return true if Update only touches this component and its owner
+	// (other than through the CommandBuffer), so it can run on job threads
+	virtual bool GetIsThreadSafe() const { return false; }
 
 	class Actor* GetOwner() { return mOwner; }
 	int GetUpdateOrder() const { return mUpdateOrder; }
@@ -71,4 +81,9 @@ protected:
 	class Actor* mOwner;
 	// Update order of component
 	int mUpdateOrder;
+private:
+	friend class ComponentRegistry;
+	// Batch in the registry this component updates in (and where)
+	struct ComponentBatch* mBatch;
+	size_t mBatchIndex;
 };
@@ -0,0 +1,172 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "ComponentRegistry.h"
+#include "Actor.h"
+#include "Game.h"
+#include "JobSystem.h"
+#include "CommandBuffer.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace
+{
+	// Components per job for thread-safe batches
+	const size_t UpdateGrainSize = 128;
+}
+
+ComponentRegistry::ComponentRegistry(Game* game)
+	:mGame(game)
+{
+}
+
+ComponentRegistry::~ComponentRegistry()
+{
+	for (auto batch : mBatches)
+	{
+		delete batch;
+	}
+}
+
+void ComponentRegistry::AddComponent(Component* comp)
+{
+	mPending.emplace_back(comp);
+}
+
+void ComponentRegistry::RemoveComponent(Component* comp)
+{
+	ComponentBatch* batch = comp->mBatch;
+	if (batch == nullptr)
+	{
+		// Is it still pending?
+		auto iter = std::find(mPending.begin(), mPending.end(), comp);
+		if (iter != mPending.end())
+		{
+			// (erase, so the rest keep the order they were added in)
+			mPending.erase(iter);
+		}
+		return;
+	}
+
+	// Just clear the slot (a batch may be being walked right now, and
+	// moving the last component here would change the order), and
+	// compact the batch later
+	batch->mComponents[comp->mBatchIndex] = nullptr;
+	batch->mNeedsCompact = true;
+	comp->mBatch = nullptr;
+}
+
+void ComponentRegistry::Update(float deltaTime)
+{
+	PROFILE_SCOPE("ComponentRegistry::Update");
+	// Close the holes from removals since the last update
+	for (auto batch : mBatches)
+	{
+		if (batch->mNeedsCompact)
+		{
+			Compact(batch);
+		}
+	}
+	FlushPending();
+
+	JobSystem* jobs = mGame->GetJobSystem();
+	CommandBuffer* commands = mGame->GetCommandBuffer();
+	for (size_t i = 0; i < mBatches.size(); i++)
+	{
+		// Components added during this loop wait in pending,
+		// so the size can't change underneath us
+		ComponentBatch* batch = mBatches[i];
+		if (batch->mIsThreadSafe)
+		{
+			jobs->ParallelFor(batch->mComponents.size(), UpdateGrainSize,
+				[this, batch, i, deltaTime](size_t begin, size_t end) {
+					UpdateRange(batch, i, begin, end, deltaTime);
+			});
+		}
+		else
+		{
+			UpdateRange(batch, i, 0, batch->mComponents.size(), deltaTime);
+		}
+		// Apply anything the batch deferred before the next batch runs
+		commands->Execute();
+	}
+	FlushPending();
+}
+
+void ComponentRegistry::UpdateRange(ComponentBatch* batch, uint64_t batchIndex,
+	size_t begin, size_t end, float deltaTime)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		Component* comp = batch->mComponents[i];
+		if (comp && comp->GetOwner()->GetState() == Actor::EActive)
+		{
+			// Commands run in batch/component order, however the
+			// batch was split up between threads
+			CommandBuffer::SetSortKey((batchIndex << 32) | i);
+			comp->Update(deltaTime);
+		}
+	}
+}
+
+void ComponentRegistry::FlushPending()
+{
+	for (auto comp : mPending)
+	{
+		int order = comp->GetUpdateOrder();
+		Component::TypeID type = comp->GetType();
+
+		// Find the batch for this order/type (or where it should go)
+		auto iter = std::lower_bound(mBatches.begin(), mBatches.end(), comp,
+			[](const ComponentBatch* b, const Component* c) {
+				if (b->mUpdateOrder != c->GetUpdateOrder())
+				{
+					return b->mUpdateOrder < c->GetUpdateOrder();
+				}
+				return b->mType < c->GetType();
+			});
+
+		ComponentBatch* batch = nullptr;
+		if (iter != mBatches.end() && (*iter)->mUpdateOrder == order &&
+			(*iter)->mType == type)
+		{
+			batch = *iter;
+		}
+		else
+		{
+			batch = new ComponentBatch();
+			batch->mUpdateOrder = order;
+			batch->mType = type;
+			batch->mIsThreadSafe = comp->GetIsThreadSafe();
+			batch->mNeedsCompact = false;
+			mBatches.insert(iter, batch);
+		}
+
+		comp->mBatch = batch;
+		comp->mBatchIndex = batch->mComponents.size();
+		batch->mComponents.emplace_back(comp);
+	}
+	mPending.clear();
+}
+
+void ComponentRegistry::Compact(ComponentBatch* batch)
+{
+	// Slide the remaining components down over the null slots
+	size_t count = 0;
+	for (auto comp : batch->mComponents)
+	{
+		if (comp)
+		{
+			comp->mBatchIndex = count;
+			batch->mComponents[count] = comp;
+			count++;
+		}
+	}
+	batch->mComponents.resize(count);
+	batch->mNeedsCompact = false;
+}
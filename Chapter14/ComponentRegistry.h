@@ -0,0 +1,64 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Component.h"
+
+// All the components of one type with the same update order, stored
+// densely so a batch updates without hopping between actors. A batch
+// keeps its components in the order they were added (removals close
+// the gaps without reordering), so the update order and the command
+// sort keys are the same every run.
+struct ComponentBatch
+{
+	int mUpdateOrder;
+	Component::TypeID mType;
+	std::vector<class Component*> mComponents;
+	// Whether this type can update in parallel
+	bool mIsThreadSafe;
+	// Set if a component was removed (leaving a null slot)
+	bool mNeedsCompact;
+};
+
+class ComponentRegistry
+{
+public:
+	ComponentRegistry(class Game* game);
+	~ComponentRegistry();
+
+	// Add/remove components (called by Actor). A removal only clears
+	// its slot, and the batch is compacted once before its next update
+	// (so removing many in one tick costs about the same as one).
+	void AddComponent(class Component* comp);
+	void RemoveComponent(class Component* comp);
+
+	// Update every component of an active actor, one batch at a time
+	// (in update order, and by type within the same update order).
+	// Thread-safe batches are split over the job system.
+	void Update(float deltaTime);
+
+	const std::vector<ComponentBatch*>& GetBatches() const { return mBatches; }
+private:
+	// Sort any pending components into their batches
+	void FlushPending();
+	// Remove null slots left by removals (keeping the order)
+	void Compact(ComponentBatch* batch);
+	// Update components [begin, end) of the batch
+	void UpdateRange(ComponentBatch* batch, uint64_t batchIndex,
+		size_t begin, size_t end, float deltaTime);
+
+	class Game* mGame;
+	// Batches sorted by update order, then type
+	std::vector<ComponentBatch*> mBatches;
+	// Components added since the last flush. These can't go in a
+	// batch right away, because the component constructor hasn't
+	// finished yet (so GetType isn't safe to call)
+	std::vector<class Component*> mPending;
+};
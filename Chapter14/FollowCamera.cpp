@@ -9,6 +9,8 @@
 #include "FollowCamera.h"
 #include "Actor.h"
 #include "LevelLoader.h"
+#include "Game.h"
+#include "CommandBuffer.h"
 
 FollowCamera::FollowCamera(Actor* owner)
 	:CameraComponent(owner)
@@ -41,7 +43,10 @@ void FollowCamera::Update(float deltaTime)
 	// Use actual position here, not ideal
 	Matrix4 view = Matrix4::CreateLookAt(mActualPos, target,
 		Vector3::UnitZ);
-	SetViewMatrix(view);
+	// This may be on a job thread, so pass to the renderer/audio later
+	mOwner->GetGame()->GetCommandBuffer()->Push([this, view]() {
+		SetViewMatrix(view);
+	});
 }
 
 void FollowCamera::SnapToIdeal()
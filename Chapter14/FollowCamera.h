@@ -15,6 +15,8 @@ public:
 	FollowCamera(class Actor* owner);
 
 	void Update(float deltaTime) override;
+	// The spring math is independent; the view is handed off deferred
+	bool GetIsThreadSafe() const override { return true; }
 	
 	void SnapToIdeal();
 
@@ -9,7 +9,9 @@
 #include "Game.h"
 #include <algorithm>
 #include "Renderer.h"
+#include "NullRenderer.h"
 #include "AudioSystem.h"
+#include "NullAudioSystem.h"
 #include "PhysWorld.h"
 #include "Actor.h"
 #include "UIScreen.h"
@@ -28,27 +30,65 @@
 #include "Animation.h"
 #include "PointLightComponent.h"
 #include "LevelLoader.h"
+#include "ComponentRegistry.h"
+#include "ObjectPool.h"
+#include "JobSystem.h"
+#include "CommandBuffer.h"
+#include "TransformSystem.h"
+#include "Profiler.h"
+#include "InputRecorder.h"
+#include "Random.h"
+#include <cstring>
+#include <thread>
 
 Game::Game()
 :mRenderer(nullptr)
 ,mAudioSystem(nullptr)
 ,mPhysWorld(nullptr)
+,mComponentRegistry(nullptr)
+,mJobSystem(nullptr)
+,mTransformSystem(nullptr)
+,mCommandBuffer(nullptr)
+,mNumWorkers(-1)
+,mFrameCounter(0)
+,mAccumulator(0.0)
+,mMaxStepsPerFrame(5)
+,mMaxFrameRate(0.0f)
+,mInterpAlpha(0.0f)
+,mTickCount(0)
+,mTickLimit(0)
+,mStartCounter(0)
+,mIsHeadless(false)
 ,mGameState(EGameplay)
 ,mUpdatingActors(false)
+,mInputRecorder(nullptr)
+,mNumSpawned(0)
+,mNumDespawned(0)
+,mTotalSpawned(0)
+,mTotalDespawned(0)
 {
-	
+	SetTickRate(60.0f);
 }
 
 bool Game::Initialize()
 {
-	if (SDL_Init(SDL_INIT_VIDEO|SDL_INIT_AUDIO) != 0)
+	// Headless doesn't need video/audio (events still catch Ctrl+C)
+	Uint32 sdlFlags = mIsHeadless ? SDL_INIT_EVENTS : (SDL_INIT_VIDEO|SDL_INIT_AUDIO);
+	if (SDL_Init(sdlFlags) != 0)
 	{
 		SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
 		return false;
 	}
 
 	// Create the renderer
-	mRenderer = new Renderer(this);
+	if (mIsHeadless)
+	{
+		mRenderer = new NullRenderer(this);
+	}
+	else
+	{
+		mRenderer = new Renderer(this);
+	}
 	if (!mRenderer->Initialize(1024.0f, 768.0f))
 	{
 		SDL_Log("Failed to initialize renderer");
@@ -58,7 +98,14 @@ bool Game::Initialize()
 	}
 
 	// Create the audio system
-	mAudioSystem = new AudioSystem(this);
+	if (mIsHeadless)
+	{
+		mAudioSystem = new NullAudioSystem(this);
+	}
+	else
+	{
+		mAudioSystem = new AudioSystem(this);
+	}
 	if (!mAudioSystem->Initialize())
 	{
 		SDL_Log("Failed to initialize audio system");
@@ -70,6 +117,15 @@ bool Game::Initialize()
 
 	// Create the physics world
 	mPhysWorld = new PhysWorld(this);
+
+	// Start the job system, and command buffer to defer changes from jobs
+	mJobSystem = new JobSystem();
+	mJobSystem->Initialize(mNumWorkers);
+	mCommandBuffer = new CommandBuffer(mJobSystem->GetNumThreads());
+
+	// Create the registry that updates components
+	mComponentRegistry = new ComponentRegistry(this);
+	mTransformSystem = new TransformSystem(this);
 	
 	// Initialize SDL_ttf
 	if (TTF_Init() != 0)
@@ -78,25 +134,69 @@ bool Game::Initialize()
 		return false;
 	}
 
+	// Seed before loading, in case the level uses random numbers
+	Random::Init();
+	mInputRecorder = new InputRecorder();
+	if (!mReplayFile.empty())
+	{
+		// Play back with the recording's seed and tick rate
+		uint32_t seed = 0;
+		float tickRate = 0.0f;
+		if (!mInputRecorder->StartReplay(mReplayFile, seed, tickRate))
+		{
+			return false;
+		}
+		Random::Seed(seed);
+		SetTickRate(tickRate);
+	}
+	else if (!mRecordFile.empty())
+	{
+		mInputRecorder->StartRecording(mRecordFile, Random::GetSeed(), mTickRate);
+	}
+	memset(mTickInput.mKeys, 0, sizeof(mTickInput.mKeys));
+	mTickInput.mMouseRelX = 0;
+	mTickInput.mMouseRelY = 0;
+	mTickInput.mMouseButtons = 0;
+
 	LoadData();
 
-	mTicksCount = SDL_GetTicks();
+	mFrameCounter = SDL_GetPerformanceCounter();
 	
 	return true;
 }
 
 void Game::RunLoop()
 {
+	mStartCounter = SDL_GetPerformanceCounter();
 	while (mGameState != EQuit)
 	{
 		ProcessInput();
 		UpdateGame();
 		GenerateOutput();
+		WaitForNextFrame();
+		if (Profiler::GetIsEnabled())
+		{
+			Profiler::EndFrame();
+		}
+	}
+
+	if (mIsHeadless)
+	{
+		// Report how fast the simulation ran
+		double seconds = static_cast<double>(SDL_GetPerformanceCounter() - mStartCounter) /
+			SDL_GetPerformanceFrequency();
+		SDL_Log("Ran %llu ticks in %.3f s (%.1f ticks/s)",
+			static_cast<unsigned long long>(mTickCount), seconds,
+			seconds > 0.0 ? mTickCount / seconds : 0.0);
+		SDL_Log("Spawned %llu actors, despawned %llu",
+			static_cast<unsigned long long>(mTotalSpawned),
+			static_cast<unsigned long long>(mTotalDespawned));
 	}
 }
 
 void Game::ProcessInput()
 {
+	PROFILE_SCOPE("Game::ProcessInput");
 	SDL_Event event;
 	while (SDL_PollEvent(&event))
 	{
@@ -111,7 +211,16 @@ void Game::ProcessInput()
 				{
 					if (mGameState == EGameplay)
 					{
-						HandleKeyPress(event.key.keysym.sym);
+						// (a replay plays back the recorded presses instead)
+						if (mInputRecorder->GetMode() != InputRecorder::EReplay)
+						{
+							// Pausing isn't recorded, since paused time isn't
+							if (event.key.keysym.sym != SDLK_ESCAPE)
+							{
+								mInputRecorder->AddKeyPress(event.key.keysym.sym);
+							}
+							HandleKeyPress(event.key.keysym.sym);
+						}
 					}
 					else if (!mUIStack.empty())
 					{
@@ -123,7 +232,11 @@ void Game::ProcessInput()
 			case SDL_MOUSEBUTTONDOWN:
 				if (mGameState == EGameplay)
 				{
-					HandleKeyPress(event.button.button);
+					if (mInputRecorder->GetMode() != InputRecorder::EReplay)
+					{
+						mInputRecorder->AddKeyPress(event.button.button);
+						HandleKeyPress(event.button.button);
+					}
 				}
 				else if (!mUIStack.empty())
 				{
@@ -136,18 +249,10 @@ void Game::ProcessInput()
 		}
 	}
 	
+	// Actors get their input in StepSimulation (once per tick),
+	// but UI input is handled once per frame
 	const Uint8* state = SDL_GetKeyboardState(NULL);
-	if (mGameState == EGameplay)
-	{
-		for (auto actor : mActors)
-		{
-			if (actor->GetState() == Actor::EActive)
-			{
-				actor->ProcessInput(state);
-			}
-		}
-	}
-	else if (!mUIStack.empty())
+	if (mGameState != EGameplay && !mUIStack.empty())
 	{
 		mUIStack.back()->ProcessInput(state);
 	}
@@ -195,6 +300,18 @@ void Game::HandleKeyPress(int key)
 		LevelLoader::SaveLevel(this, "Assets/Saved.gplevel");
 		break;
 	}
+	case 'p':
+	{
+		// Toggle the profiler (and its HUD overlay)
+		Profiler::SetEnabled(!Profiler::GetIsEnabled());
+		break;
+	}
+	case 'o':
+	{
+		// Save the recent profile for chrome://tracing
+		Profiler::WriteChromeTrace("Profile.json");
+		break;
+	}
 	case SDL_BUTTON_LEFT:
 	{
 		break;
@@ -206,57 +323,59 @@ void Game::HandleKeyPress(int key)
 
 void Game::UpdateGame()
 {
-	// Compute delta time
-	// Wait until 16ms has elapsed since last frame
-	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + 16))
-		;
+	PROFILE_SCOPE("Game::UpdateGame");
+	// Compute how much real time passed since the last frame
+	Uint64 counter = SDL_GetPerformanceCounter();
+	double frameTime = static_cast<double>(counter - mFrameCounter) /
+		SDL_GetPerformanceFrequency();
+	mFrameCounter = counter;
 
-	float deltaTime = (SDL_GetTicks() - mTicksCount) / 1000.0f;
-	if (deltaTime > 0.05f)
+	float deltaTime = mTickDelta;
+	if (mIsHeadless)
 	{
-		deltaTime = 0.05f;
+		// Headless always runs exactly one tick per loop, however
+		// much real time passed (nothing is drawn to interpolate)
+		StepSimulation(mTickDelta);
 	}
-	mTicksCount = SDL_GetTicks();
-
-	if (mGameState == EGameplay)
+	else
 	{
-		// Update all actors
-		mUpdatingActors = true;
-		for (auto actor : mActors)
+		// Bank the elapsed time, but never more than the max number of
+		// steps (so a long stall doesn't snowball into more catch-up work)
+		mAccumulator += frameTime;
+		double maxAccumulated = static_cast<double>(mTickDelta) * mMaxStepsPerFrame;
+		if (mAccumulator > maxAccumulated)
 		{
-			actor->Update(deltaTime);
+			mAccumulator = maxAccumulated;
 		}
-		mUpdatingActors = false;
 
-		// Move any pending actors to mActors
-		for (auto pending : mPendingActors)
+		// Run as many fixed steps as the banked time allows
+		while (mAccumulator >= mTickDelta)
 		{
-			pending->ComputeWorldTransform();
-			mActors.emplace_back(pending);
+			StepSimulation(mTickDelta);
+			mAccumulator -= mTickDelta;
 		}
-		mPendingActors.clear();
-
-		// Add any dead actors to a temp vector
-		std::vector<Actor*> deadActors;
-		for (auto actor : mActors)
+		// Leftover time says how far between the last two ticks to render
+		mInterpAlpha = static_cast<float>(mAccumulator / mTickDelta);
+		// Ticks don't move anything while paused, so hold the last pose
+		// (rather than blending back and forth between the last two)
+		if (mGameState != EGameplay)
 		{
-			if (actor->GetState() == Actor::EDead)
-			{
-				deadActors.emplace_back(actor);
-			}
+			mInterpAlpha = 1.0f;
 		}
 
-		// Delete dead actors (which removes them from mActors)
-		for (auto actor : deadActors)
+		// Audio and UI run once per frame on (clamped) real time
+		deltaTime = static_cast<float>(frameTime);
+		if (deltaTime > 0.05f)
 		{
-			delete actor;
+			deltaTime = 0.05f;
 		}
 	}
-	
+
 	// Update audio system
 	mAudioSystem->Update(deltaTime);
 	
 	// Update UI screens
+	PROFILE_SCOPE("Game::UpdateUI");
 	for (auto ui : mUIStack)
 	{
 		if (ui->GetState() == UIScreen::EActive)
@@ -280,11 +399,224 @@ void Game::UpdateGame()
 	}
 }
 
+void Game::StepSimulation(float deltaTime)
+{
+	PROFILE_SCOPE("Game::StepSimulation");
+	if (mGameState == EGameplay)
+	{
+		// Remember where everything was at the start of this tick,
+		// so rendering can interpolate toward where it ends up
+		mTransformSystem->StorePrevTransforms();
+		mRenderer->StorePrevView();
+
+		// Process input for actors
+		if (!GatherTickInput())
+		{
+			// The replay is over
+			mGameState = EQuit;
+			return;
+		}
+		for (auto actor : mActors)
+		{
+			if (actor->GetState() == Actor::EActive)
+			{
+				actor->ProcessInput(mTickInput.mKeys);
+			}
+		}
+
+		// Update all actors
+		mUpdatingActors = true;
+		// First bring any transforms that changed last tick up to date
+		// (in one batch, which also informs the components)
+		mTransformSystem->Update();
+		mCommandBuffer->Execute();
+		// Simulate the rigid bodies
+		mPhysWorld->StepBodies(deltaTime);
+		// Refit the moved bodies' boxes, so the sweeps and casts below
+		// see where they are now
+		mTransformSystem->Update();
+		mCommandBuffer->Execute();
+		// Then components update a batch (one type) at a time
+		mComponentRegistry->Update(deltaTime);
+		// And finally any actor-specific update code
+		for (auto actor : mActors)
+		{
+			actor->Update(deltaTime);
+		}
+		mUpdatingActors = false;
+
+		FlushActorChanges();
+		// And bring whatever the updates moved (or spawned) up to date,
+		// for the casts made before the next tick
+		mTransformSystem->Update();
+		mCommandBuffer->Execute();
+
+		mTickCount++;
+		if (mTickLimit > 0 && mTickCount >= mTickLimit)
+		{
+			mGameState = EQuit;
+		}
+	}
+}
+
+bool Game::GatherTickInput()
+{
+	InputRecorder::Mode mode = mInputRecorder->GetMode();
+	// Only hash the state when it will be used
+	uint32_t checksum = mode != InputRecorder::ENone ? ComputeStateChecksum() : 0;
+
+	if (mode == InputRecorder::EReplay)
+	{
+		if (!mInputRecorder->ReadTick(mTickInput, checksum))
+		{
+			return false;
+		}
+		for (int key : mTickInput.mKeyPresses)
+		{
+			HandleKeyPress(key);
+		}
+		return true;
+	}
+
+	memcpy(mTickInput.mKeys, SDL_GetKeyboardState(NULL), sizeof(mTickInput.mKeys));
+	int x = 0, y = 0;
+	Uint32 buttons = SDL_GetRelativeMouseState(&x, &y);
+	mTickInput.mMouseRelX = static_cast<int16_t>(Math::Clamp(x, -32768, 32767));
+	mTickInput.mMouseRelY = static_cast<int16_t>(Math::Clamp(y, -32768, 32767));
+	mTickInput.mMouseButtons = static_cast<uint8_t>(buttons);
+	if (mode == InputRecorder::ERecord)
+	{
+		mInputRecorder->WriteTick(mTickInput, checksum);
+	}
+	return true;
+}
+
+uint32_t Game::ComputeStateChecksum() const
+{
+	// FNV-1a over each actor's position, rotation, and scale
+	uint32_t hash = 2166136261u;
+	auto mix = [&hash](const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+	};
+
+	uint32_t count = static_cast<uint32_t>(mActors.Size());
+	mix(&count, sizeof(count));
+	for (auto actor : mActors)
+	{
+		Vector3 pos = actor->GetPosition();
+		Quaternion rot = actor->GetRotation();
+		float scale = actor->GetScale();
+		mix(&pos, sizeof(pos));
+		mix(&rot, sizeof(rot));
+		mix(&scale, sizeof(scale));
+	}
+	return hash;
+}
+
+void Game::FlushActorChanges()
+{
+	PROFILE_SCOPE("Game::FlushActorChanges");
+	// Move any pending actors to mActors
+	mNumSpawned = mPendingActors.size();
+	for (auto pending : mPendingActors)
+	{
+		pending->ComputeWorldTransform();
+		pending->SetHandle(mActors.Insert(pending));
+	}
+	mPendingActors.clear();
+
+	// Gather the dead actors (reusing last tick's vector)
+	mDeadActors.clear();
+	for (auto actor : mActors)
+	{
+		if (actor->GetState() == Actor::EDead)
+		{
+			mDeadActors.emplace_back(actor);
+		}
+	}
+	mNumDespawned = mDeadActors.size();
+
+	if (!mDeadActors.empty())
+	{
+		// Deleting an actor removes it (and its components) from each
+		// system. In a batch these removals just leave holes, and each
+		// list is compacted once at the end, so many deaths in one
+		// tick cost about the same as one.
+		mRenderer->BeginBatchRemove();
+		mPhysWorld->BeginBatchRemove();
+		if (mHUD)
+		{
+			mHUD->BeginBatchRemove();
+		}
+		mActors.BeginBatchRemove();
+
+		for (auto actor : mDeadActors)
+		{
+			delete actor;
+		}
+
+		mActors.EndBatchRemove();
+		if (mHUD)
+		{
+			mHUD->EndBatchRemove();
+		}
+		mPhysWorld->EndBatchRemove();
+		mRenderer->EndBatchRemove();
+	}
+
+	mTotalSpawned += mNumSpawned;
+	mTotalDespawned += mNumDespawned;
+}
+
 void Game::GenerateOutput()
 {
+	PROFILE_SCOPE("Game::GenerateOutput");
+	if (mIsHeadless)
+	{
+		return;
+	}
+
+	// Blend each actor between its last two ticks
+	mTransformSystem->ComputeRenderTransforms(mInterpAlpha);
 	mRenderer->Draw();
 }
 
+void Game::WaitForNextFrame()
+{
+	// Headless is unthrottled, unless asked to hold a frame rate
+	// (like a server that should tick in real time)
+	if (mIsHeadless && mMaxFrameRate <= 0.0f)
+	{
+		return;
+	}
+
+	// Frames are paced to the tick rate unless a max frame rate is set
+	double interval = mMaxFrameRate > 0.0f ? 1.0 / mMaxFrameRate : mTickDelta;
+	Uint64 freq = SDL_GetPerformanceFrequency();
+	Uint64 nextFrame = mFrameCounter + static_cast<Uint64>(interval * freq);
+
+	// Sleep through most of the wait, and only yield for the last
+	// couple of milliseconds (SDL_Delay can oversleep a little)
+	Uint64 now = SDL_GetPerformanceCounter();
+	while (now < nextFrame)
+	{
+		double remainingMs = (nextFrame - now) * 1000.0 / freq;
+		if (remainingMs > 2.0)
+		{
+			SDL_Delay(static_cast<Uint32>(remainingMs) - 1);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+		now = SDL_GetPerformanceCounter();
+	}
+}
+
 void Game::LoadData()
 {
 	// Load English text
@@ -298,20 +630,35 @@ void Game::LoadData()
 	// Start music
 	mMusicEvent = mAudioSystem->PlayEvent("event:/Music");
 
-	// Enable relative mouse mode for camera look
-	SDL_SetRelativeMouseMode(SDL_TRUE);
-	// Make an initial call to get relative to clear out
-	SDL_GetRelativeMouseState(nullptr, nullptr);
+	// No mouse to capture without a window
+	if (!mIsHeadless)
+	{
+		// Enable relative mouse mode for camera look
+		SDL_SetRelativeMouseMode(SDL_TRUE);
+		// Make an initial call to get relative to clear out
+		SDL_GetRelativeMouseState(nullptr, nullptr);
+	}
 }
 
 void Game::UnloadData()
 {
 	// Delete actors
 	// Because ~Actor calls RemoveActor, have to use a different style loop
-	while (!mActors.empty())
+	while (!mActors.Empty())
 	{
-		delete mActors.back();
+		delete mActors.Back();
 	}
+	// With the level's actors gone, its arena can go all at once
+	ObjectAllocator::ResetLevelArena();
+
+	const ObjectAllocStats& stats = ObjectAllocator::GetStats();
+	SDL_Log("Actor/component allocations: %u pooled, %u level arena, %u heap "
+		"(peak %u alive, %u KB in pools)",
+		static_cast<unsigned>(stats.mPoolAllocs),
+		static_cast<unsigned>(stats.mArenaAllocs),
+		static_cast<unsigned>(stats.mHeapAllocs),
+		static_cast<unsigned>(stats.mPeakLiveObjects),
+		static_cast<unsigned>(stats.mPoolBytesReserved / 1024));
 
 	// Clear the UI stack
 	while (!mUIStack.empty())
@@ -350,6 +697,22 @@ void Game::Shutdown()
 	UnloadData();
 	TTF_Quit();
 	delete mPhysWorld;
+	delete mComponentRegistry;
+	delete mTransformSystem;
+	delete mCommandBuffer;
+	if (mJobSystem)
+	{
+		mJobSystem->Shutdown();
+		delete mJobSystem;
+	}
+	// (after the job threads have exited)
+	Profiler::Shutdown();
+	if (mInputRecorder)
+	{
+		mInputRecorder->Stop();
+		delete mInputRecorder;
+		mInputRecorder = nullptr;
+	}
 	if (mRenderer)
 	{
 		mRenderer->Shutdown();
@@ -358,9 +721,16 @@ void Game::Shutdown()
 	{
 		mAudioSystem->Shutdown();
 	}
+	ObjectAllocator::Shutdown();
 	SDL_Quit();
 }
 
+void Game::SetTickRate(float ticksPerSecond)
+{
+	mTickRate = ticksPerSecond;
+	mTickDelta = 1.0f / ticksPerSecond;
+}
+
 void Game::AddActor(Actor* actor)
 {
 	// If we're updating actors, need to add to pending
@@ -370,13 +740,20 @@ void Game::AddActor(Actor* actor)
 	}
 	else
 	{
-		mActors.emplace_back(actor);
+		actor->SetHandle(mActors.Insert(actor));
 	}
 }
 
 void Game::RemoveActor(Actor* actor)
 {
-	// Is it in pending actors?
+	// Actors in mActors have a handle, so removal is O(1)
+	if (mActors.Remove(actor->GetHandle()))
+	{
+		actor->SetHandle(SlotHandle());
+		return;
+	}
+
+	// Otherwise it must be pending
 	auto iter = std::find(mPendingActors.begin(), mPendingActors.end(), actor);
 	if (iter != mPendingActors.end())
 	{
@@ -384,15 +761,12 @@ void Game::RemoveActor(Actor* actor)
 		std::iter_swap(iter, mPendingActors.end() - 1);
 		mPendingActors.pop_back();
 	}
+}
 
-	// Is it in actors?
-	iter = std::find(mActors.begin(), mActors.end(), actor);
-	if (iter != mActors.end())
-	{
-		// Swap to end of vector and pop off (avoid erase copies)
-		std::iter_swap(iter, mActors.end() - 1);
-		mActors.pop_back();
-	}
+Actor* Game::GetActor(SlotHandle handle)
+{
+	Actor** actor = mActors.Get(handle);
+	return actor ? *actor : nullptr;
 }
 
 void Game::PushUI(UIScreen* screen)
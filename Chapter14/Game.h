@@ -12,6 +12,8 @@
 #include <vector>
 #include "Math.h"
 #include "SoundEvent.h"
+#include "SlotMap.h"
+#include "InputRecorder.h"
 #include <SDL/SDL_types.h>
 
 class Game
@@ -24,11 +26,24 @@ public:
 
 	void AddActor(class Actor* actor);
 	void RemoveActor(class Actor* actor);
+	// Look up an actor by handle (nullptr if it's since been deleted)
+	class Actor* GetActor(SlotHandle handle);
+	// End of tick: move pending actors in, and delete dead ones
+	// (in one batch, so it's also the quick way to clear a scene)
+	void FlushActorChanges();
 
 	class Renderer* GetRenderer() { return mRenderer; }
 	class AudioSystem* GetAudioSystem() { return mAudioSystem; }
 	class PhysWorld* GetPhysWorld() { return mPhysWorld; }
 	class HUD* GetHUD() { return mHUD; }
+	class ComponentRegistry* GetComponentRegistry() { return mComponentRegistry; }
+	class JobSystem* GetJobSystem() { return mJobSystem; }
+	class TransformSystem* GetTransformSystem() { return mTransformSystem; }
+	// Deferred changes from code running on job threads
+	class CommandBuffer* GetCommandBuffer() { return mCommandBuffer; }
+	// Worker threads for the job system (-1 for one per core, must be
+	// set before Initialize)
+	void SetNumWorkers(int workers) { mNumWorkers = workers; }
 	
 	// Manage UI stack
 	const std::vector<class UIScreen*>& GetUIStack() { return mUIStack; }
@@ -55,18 +70,55 @@ public:
 
 	class Animation* GetAnimation(const std::string& fileName);
 
-	const std::vector<class Actor*>& GetActors() const { return mActors; }
+	const std::vector<class Actor*>& GetActors() const { return mActors.GetDense(); }
 	void SetFollowActor(class FollowActor* actor) { mFollowActor = actor; }
+
+	// Fixed-step simulation (actors always update by 1/tickRate seconds)
+	void SetTickRate(float ticksPerSecond);
+	float GetTickRate() const { return mTickRate; }
+	float GetTickDelta() const { return mTickDelta; }
+	// Most simulation steps run in one frame when catching up
+	void SetMaxStepsPerFrame(int steps) { mMaxStepsPerFrame = steps; }
+	// Cap on rendered frames per second (0 means one frame per tick)
+	void SetMaxFrameRate(float fps) { mMaxFrameRate = fps; }
+	// How far (0 to 1) this frame is between the last two ticks
+	float GetInterpolationAlpha() const { return mInterpAlpha; }
+
+	// Headless runs have no window, GL or FMOD, and run one tick
+	// per loop as fast as they can (must be set before Initialize)
+	void SetHeadless(bool headless) { mIsHeadless = headless; }
+	bool GetIsHeadless() const { return mIsHeadless; }
+	// Number of simulation ticks run so far
+	Uint64 GetTickCount() const { return mTickCount; }
+	// Quit after this many ticks (0 means run until quit)
+	void SetTickLimit(Uint64 ticks) { mTickLimit = ticks; }
+	// Record every tick's input to a file, or replay a recording
+	// (replays should run headless; set before Initialize)
+	void SetRecordFile(const std::string& fileName) { mRecordFile = fileName; }
+	void SetReplayFile(const std::string& fileName) { mReplayFile = fileName; }
+	// This tick's input (live, or from the replay)
+	const TickInput& GetTickInput() const { return mTickInput; }
+	// Actors added/deleted at the end of the most recent tick
+	size_t GetNumSpawned() const { return mNumSpawned; }
+	size_t GetNumDespawned() const { return mNumDespawned; }
 private:
 	void ProcessInput();
 	void HandleKeyPress(int key);
 	void UpdateGame();
+	// Advance the simulation by one fixed step
+	void StepSimulation(float deltaTime);
 	void GenerateOutput();
+	// Sleep until the next frame is due
+	void WaitForNextFrame();
+	// Fill in mTickInput for this tick (returns false when a replay ends)
+	bool GatherTickInput();
+	// Hash of the actor transforms (to check a replay stays in sync)
+	uint32_t ComputeStateChecksum() const;
 	void LoadData();
 	void UnloadData();
 	
 	// All the actors in the game
-	std::vector<class Actor*> mActors;
+	SlotMap<class Actor*> mActors;
 	std::vector<class UIScreen*> mUIStack;
 	// Map for fonts
 	std::unordered_map<std::string, class Font*> mFonts;
@@ -84,11 +136,39 @@ private:
 	class AudioSystem* mAudioSystem;
 	class PhysWorld* mPhysWorld;
 	class HUD* mHUD;
+	class ComponentRegistry* mComponentRegistry;
+	class JobSystem* mJobSystem;
+	class TransformSystem* mTransformSystem;
+	class CommandBuffer* mCommandBuffer;
+	int mNumWorkers;
 
-	Uint32 mTicksCount;
+	// Fixed-step timing
+	Uint64 mFrameCounter;
+	double mAccumulator;
+	float mTickRate;
+	float mTickDelta;
+	int mMaxStepsPerFrame;
+	float mMaxFrameRate;
+	float mInterpAlpha;
+	Uint64 mTickCount;
+	Uint64 mTickLimit;
+	// Counter when RunLoop started (for the headless summary)
+	Uint64 mStartCounter;
+	bool mIsHeadless;
 	GameState mGameState;
 	// Track if we're updating actors right now
 	bool mUpdatingActors;
+	// Record/replay
+	class InputRecorder* mInputRecorder;
+	TickInput mTickInput;
+	std::string mRecordFile;
+	std::string mReplayFile;
+	// Scratch for FlushActorChanges (kept to reuse its memory)
+	std::vector<class Actor*> mDeadActors;
+	size_t mNumSpawned;
+	size_t mNumDespawned;
+	Uint64 mTotalSpawned;
+	Uint64 mTotalDespawned;
 
 	// Game-specific code
 	class FollowActor* mFollowActor;
@@ -8,20 +8,25 @@
 
 #include "HUD.h"
 #include "Texture.h"
-#include "Shader.h"
+#include "SpriteBatch.h"
 #include "Game.h"
 #include "Renderer.h"
 #include "PhysWorld.h"
+#include "BoxComponent.h"
 #include "FollowActor.h"
 #include <algorithm>
 #include "GBuffer.h"
 #include "TargetComponent.h"
+#include "Font.h"
+#include "Profiler.h"
+#include <cstdio>
 
 HUD::HUD(Game* game)
 	:UIScreen(game)
 	,mRadarRange(2000.0f)
 	,mRadarRadius(92.0f)
 	,mTargetEnemy(false)
+	,mProfileRefresh(0.0f)
 {
 	Renderer* r = mGame->GetRenderer();
 	mHealthBar = r->GetTexture("Assets/HealthBar.png");
@@ -34,6 +39,7 @@ HUD::HUD(Game* game)
 
 HUD::~HUD()
 {
+	ClearProfile();
 }
 
 void HUD::Update(float deltaTime)
@@ -42,44 +48,52 @@ void HUD::Update(float deltaTime)
 	
 	UpdateCrosshair(deltaTime);
 	UpdateRadar(deltaTime);
+	UpdateProfile(deltaTime);
 }
 
-void HUD::Draw(Shader* shader)
+void HUD::Draw(SpriteBatch* batch)
 {
 	// Crosshair
 	//Texture* cross = mTargetEnemy ? mCrosshairEnemy : mCrosshair;
-	//DrawTexture(shader, cross, Vector2::Zero, 2.0f);
+	//DrawTexture(batch, cross, Vector2::Zero, 2.0f);
 	
 	// Radar
 	const Vector2 cRadarPos(-390.0f, 275.0f);
-	DrawTexture(shader, mRadar, cRadarPos, 1.0f);
+	DrawTexture(batch, mRadar, cRadarPos, 1.0f);
 	// Blips
 	for (Vector2& blip : mBlips)
 	{
-		DrawTexture(shader, mBlipTex, cRadarPos + blip, 1.0f);
+		DrawTexture(batch, mBlipTex, cRadarPos + blip, 1.0f);
 	}
 	// Radar arrow
-	DrawTexture(shader, mRadarArrow, cRadarPos);
+	DrawTexture(batch, mRadarArrow, cRadarPos);
+
+	// Profiler overlay (top left, left aligned)
+	Vector2 linePos(-500.0f, 360.0f);
+	for (auto line : mProfileLines)
+	{
+		DrawTexture(batch, line,
+			Vector2(linePos.x + line->GetWidth() * 0.5f, linePos.y));
+		linePos.y -= 20.0f;
+	}
 	
 	//// Health bar
-	//DrawTexture(shader, mHealthBar, Vector2(-350.0f, -350.0f));
+	//DrawTexture(batch, mHealthBar, Vector2(-350.0f, -350.0f));
 	// Draw the mirror (bottom left)
 	//Texture* mirror = mGame->GetRenderer()->GetMirrorTexture();
-	//DrawTexture(shader, mirror, Vector2(-350.0f, -250.0f), 1.0f, true);
+	//DrawTexture(batch, mirror, Vector2(-350.0f, -250.0f), 1.0f, true);
 	//Texture* tex = mGame->GetRenderer()->GetGBuffer()->GetTexture(GBuffer::EDiffuse);
-	//DrawTexture(shader, tex, Vector2::Zero, 1.0f, true);
+	//DrawTexture(batch, tex, Vector2::Zero, 1.0f, true);
 }
 
-void HUD::AddTargetComponent(TargetComponent* tc)
+SlotHandle HUD::AddTargetComponent(TargetComponent* tc)
 {
-	mTargetComps.emplace_back(tc);
+	return mTargetComps.Insert(tc);
 }
 
-void HUD::RemoveTargetComponent(TargetComponent* tc)
+void HUD::RemoveTargetComponent(SlotHandle handle)
 {
-	auto iter = std::find(mTargetComps.begin(), mTargetComps.end(),
-		tc);
-	mTargetComps.erase(iter);
+	mTargetComps.Remove(handle);
 }
 
 void HUD::UpdateCrosshair(float deltaTime)
@@ -91,22 +105,58 @@ void HUD::UpdateCrosshair(float deltaTime)
 	Vector3 start, dir;
 	mGame->GetRenderer()->GetScreenDirection(start, dir);
 	LineSegment l(start, start + dir * cAimDist);
-	// Segment cast
+	// Segment cast (against everything, so walls block the aim)
 	PhysWorld::CollisionInfo info;
 	if (mGame->GetPhysWorld()->SegmentCast(l, info))
 	{
 		// Is this a target?
-		for (auto tc : mTargetComps)
+		mTargetEnemy = (info.mBox->GetLayer() & PhysWorld::ELayerTarget) != 0;
+	}
+}
+
+void HUD::UpdateProfile(float deltaTime)
+{
+	// Headless runs have no GL context to render the text into (the
+	// -profile trace is still written)
+	if (!Profiler::GetIsEnabled() || mGame->GetIsHeadless())
+	{
+		ClearProfile();
+		return;
+	}
+
+	// Rendering text every frame is slow (and would be unreadable),
+	// so only redraw a couple times a second
+	mProfileRefresh -= deltaTime;
+	if (mProfileRefresh > 0.0f)
+	{
+		return;
+	}
+	mProfileRefresh = 0.5f;
+
+	ClearProfile();
+	char line[128];
+	for (const auto& stat : Profiler::GetStats())
+	{
+		snprintf(line, sizeof(line), "%s  %.2f ms  (x%u)",
+			stat.mName, stat.mAvgMs, stat.mLastCalls);
+		Texture* tex = mFont->RenderRawText(line, Color::Green, 18);
+		if (tex)
 		{
-			if (tc->GetOwner() == info.mActor)
-			{
-				mTargetEnemy = true;
-				break;
-			}
+			mProfileLines.emplace_back(tex);
 		}
 	}
 }
 
+void HUD::ClearProfile()
+{
+	for (auto line : mProfileLines)
+	{
+		line->Unload();
+		delete line;
+	}
+	mProfileLines.clear();
+}
+
 void HUD::UpdateRadar(float deltaTime)
 {
 	// Clear blip positions from last frame
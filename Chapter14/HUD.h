@@ -9,6 +9,7 @@
 #pragma once
 #include "UIScreen.h"
 #include <vector>
+#include "SlotMap.h"
 
 class HUD : public UIScreen
 {
@@ -18,13 +19,20 @@ public:
 	~HUD();
 
 	void Update(float deltaTime) override;
-	void Draw(class Shader* shader) override;
+	void Draw(class SpriteBatch* batch) override;
 	
-	void AddTargetComponent(class TargetComponent* tc);
-	void RemoveTargetComponent(class TargetComponent* tc);
+	// Add returns the handle to remove with
+	SlotHandle AddTargetComponent(class TargetComponent* tc);
+	void RemoveTargetComponent(SlotHandle handle);
+	// Removals in between are compacted all at once by the End call
+	void BeginBatchRemove() { mTargetComps.BeginBatchRemove(); }
+	void EndBatchRemove() { mTargetComps.EndBatchRemove(); }
 protected:
 	void UpdateCrosshair(float deltaTime);
 	void UpdateRadar(float deltaTime);
+	// Redraw the profiler overlay text (while profiling)
+	void UpdateProfile(float deltaTime);
+	void ClearProfile();
 	
 	class Texture* mHealthBar;
 	class Texture* mRadar;
@@ -34,7 +42,7 @@ protected:
 	class Texture* mRadarArrow;
 	
 	// All the target components in the game
-	std::vector<class TargetComponent*> mTargetComps;
+	SlotMap<class TargetComponent*> mTargetComps;
 	// 2D offsets of blips relative to radar
 	std::vector<Vector2> mBlips;
 	// Adjust range of radar and radius
@@ -42,4 +50,8 @@ protected:
 	float mRadarRadius;
 	// Whether the crosshair targets an enemy
 	bool mTargetEnemy;
+	// Profiler overlay, one texture per line
+	std::vector<class Texture*> mProfileLines;
+	// Time until the overlay text is redrawn
+	float mProfileRefresh;
 };
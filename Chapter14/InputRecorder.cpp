@@ -0,0 +1,215 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "InputRecorder.h"
+#include <cstring>
+#include <SDL/SDL_log.h>
+
+namespace
+{
+	const char RecordMagic[4] = { 'G', 'P', 'I', 'R' };
+	const uint32_t RecordVersion = 1;
+
+	template <typename T>
+	void Write(std::fstream& file, const T& value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool Read(std::fstream& file, T& value)
+	{
+		file.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return file.good();
+	}
+}
+
+InputRecorder::InputRecorder()
+	:mMode(ENone)
+	,mNumTicks(0)
+	,mFirstMismatch(-1)
+{
+	memset(mPrevKeys, 0, sizeof(mPrevKeys));
+}
+
+InputRecorder::~InputRecorder()
+{
+	Stop();
+}
+
+bool InputRecorder::StartRecording(const std::string& fileName, uint32_t seed, float tickRate)
+{
+	Stop();
+	mFile.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!mFile.is_open())
+	{
+		SDL_Log("Failed to open recording %s", fileName.c_str());
+		return false;
+	}
+
+	mFile.write(RecordMagic, sizeof(RecordMagic));
+	Write(mFile, RecordVersion);
+	Write(mFile, seed);
+	Write(mFile, tickRate);
+
+	mMode = ERecord;
+	mFileName = fileName;
+	return true;
+}
+
+bool InputRecorder::StartReplay(const std::string& fileName, uint32_t& outSeed, float& outTickRate)
+{
+	Stop();
+	mFile.open(fileName, std::ios::in | std::ios::binary);
+	if (!mFile.is_open())
+	{
+		SDL_Log("Failed to open recording %s", fileName.c_str());
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	mFile.read(magic, sizeof(magic));
+	if (!mFile.good() || memcmp(magic, RecordMagic, sizeof(magic)) != 0 ||
+		!Read(mFile, version) || version != RecordVersion ||
+		!Read(mFile, outSeed) || !Read(mFile, outTickRate))
+	{
+		SDL_Log("%s is not a valid recording", fileName.c_str());
+		mFile.close();
+		return false;
+	}
+
+	mMode = EReplay;
+	mFileName = fileName;
+	return true;
+}
+
+void InputRecorder::Stop()
+{
+	if (mMode == ERecord)
+	{
+		SDL_Log("Recorded %llu ticks to %s",
+			static_cast<unsigned long long>(mNumTicks), mFileName.c_str());
+	}
+	else if (mMode == EReplay)
+	{
+		if (mFirstMismatch >= 0)
+		{
+			SDL_Log("Replay diverged from the recording at tick %lld",
+				static_cast<long long>(mFirstMismatch));
+		}
+		else
+		{
+			SDL_Log("Replayed %llu ticks, matching the recording",
+				static_cast<unsigned long long>(mNumTicks));
+		}
+	}
+
+	if (mFile.is_open())
+	{
+		mFile.close();
+	}
+	mMode = ENone;
+	mNumTicks = 0;
+	mFirstMismatch = -1;
+	memset(mPrevKeys, 0, sizeof(mPrevKeys));
+	mPendingPresses.clear();
+}
+
+void InputRecorder::AddKeyPress(int key)
+{
+	if (mMode == ERecord)
+	{
+		mPendingPresses.emplace_back(key);
+	}
+}
+
+void InputRecorder::WriteTick(const TickInput& input, uint32_t checksum)
+{
+	Write(mFile, checksum);
+
+	// Only the keys that changed since last tick
+	uint16_t changed[SDL_NUM_SCANCODES];
+	uint16_t numChanged = 0;
+	for (uint16_t i = 0; i < SDL_NUM_SCANCODES; i++)
+	{
+		if ((input.mKeys[i] != 0) != (mPrevKeys[i] != 0))
+		{
+			changed[numChanged++] = i;
+			mPrevKeys[i] = input.mKeys[i] ? 1 : 0;
+		}
+	}
+	Write(mFile, numChanged);
+	mFile.write(reinterpret_cast<const char*>(changed), numChanged * sizeof(uint16_t));
+
+	Write(mFile, input.mMouseRelX);
+	Write(mFile, input.mMouseRelY);
+	Write(mFile, input.mMouseButtons);
+
+	uint8_t numPresses = static_cast<uint8_t>(mPendingPresses.size() < 255 ?
+		mPendingPresses.size() : 255);
+	Write(mFile, numPresses);
+	for (uint8_t i = 0; i < numPresses; i++)
+	{
+		int32_t key = mPendingPresses[i];
+		Write(mFile, key);
+	}
+	mPendingPresses.clear();
+	mNumTicks++;
+}
+
+bool InputRecorder::ReadTick(TickInput& outInput, uint32_t checksum)
+{
+	uint32_t recorded = 0;
+	if (!Read(mFile, recorded))
+	{
+		// End of the recording
+		return false;
+	}
+	if (recorded != checksum && mFirstMismatch < 0)
+	{
+		mFirstMismatch = static_cast<int64_t>(mNumTicks);
+		SDL_Log("Replay state doesn't match the recording at tick %llu",
+			static_cast<unsigned long long>(mNumTicks));
+	}
+
+	uint16_t numChanged = 0;
+	if (!Read(mFile, numChanged) || numChanged > SDL_NUM_SCANCODES)
+	{
+		return false;
+	}
+	for (uint16_t i = 0; i < numChanged; i++)
+	{
+		uint16_t scancode = 0;
+		if (!Read(mFile, scancode) || scancode >= SDL_NUM_SCANCODES)
+		{
+			return false;
+		}
+		mPrevKeys[scancode] = !mPrevKeys[scancode];
+	}
+	memcpy(outInput.mKeys, mPrevKeys, sizeof(mPrevKeys));
+
+	uint8_t numPresses = 0;
+	if (!Read(mFile, outInput.mMouseRelX) || !Read(mFile, outInput.mMouseRelY) ||
+		!Read(mFile, outInput.mMouseButtons) || !Read(mFile, numPresses))
+	{
+		return false;
+	}
+	outInput.mKeyPresses.clear();
+	for (uint8_t i = 0; i < numPresses; i++)
+	{
+		int32_t key = 0;
+		if (!Read(mFile, key))
+		{
+			return false;
+		}
+		outInput.mKeyPresses.emplace_back(key);
+	}
+	mNumTicks++;
+	return true;
+}
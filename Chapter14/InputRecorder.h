@@ -0,0 +1,77 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <SDL/SDL_scancode.h>
+
+// Everything the simulation reads from input in one tick
+struct TickInput
+{
+	// Keyboard state (indexed by scancode, like SDL_GetKeyboardState)
+	uint8_t mKeys[SDL_NUM_SCANCODES];
+	// Relative mouse motion and button state
+	int16_t mMouseRelX;
+	int16_t mMouseRelY;
+	uint8_t mMouseButtons;
+	// Gameplay key presses handled before this tick
+	std::vector<int> mKeyPresses;
+};
+
+// Records the input for every simulation tick (and the random seed)
+// to a compact binary file, or plays one back.
+// Each tick stores only the keys that changed since the previous tick,
+// plus a checksum of the game state, so a replay can report the first
+// tick where it diverged from the recording.
+class InputRecorder
+{
+public:
+	enum Mode
+	{
+		ENone,
+		ERecord,
+		EReplay
+	};
+
+	InputRecorder();
+	~InputRecorder();
+
+	// Seed and tick rate are written to the file header
+	bool StartRecording(const std::string& fileName, uint32_t seed, float tickRate);
+	// Read the file header (the seed and tick rate to use)
+	bool StartReplay(const std::string& fileName, uint32_t& outSeed, float& outTickRate);
+	void Stop();
+
+	// A gameplay key press happened (recorded with the next tick)
+	void AddKeyPress(int key);
+
+	// Record this tick's input, along with the state checksum at the
+	// start of the tick
+	void WriteTick(const TickInput& input, uint32_t checksum);
+	// Read the next tick's input, and check the state checksum against
+	// the recording. Returns false at the end of the recording.
+	bool ReadTick(TickInput& outInput, uint32_t checksum);
+
+	Mode GetMode() const { return mMode; }
+	uint64_t GetNumTicks() const { return mNumTicks; }
+	// First tick whose checksum didn't match (-1 if none)
+	int64_t GetFirstMismatch() const { return mFirstMismatch; }
+private:
+	Mode mMode;
+	std::fstream mFile;
+	std::string mFileName;
+	// Key state of the previous tick (to store only the changes)
+	uint8_t mPrevKeys[SDL_NUM_SCANCODES];
+	// Key presses since the last recorded tick
+	std::vector<int> mPendingPresses;
+	uint64_t mNumTicks;
+	int64_t mFirstMismatch;
+};
@@ -0,0 +1,196 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "JobSystem.h"
+#include "Profiler.h"
+
+thread_local int JobSystem::sThreadIndex = 0;
+
+JobSystem::JobSystem()
+	:mQueuedJobs(0)
+	,mRunning(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Initialize(int numWorkers)
+{
+	if (numWorkers < 0)
+	{
+		int cores = static_cast<int>(std::thread::hardware_concurrency());
+		numWorkers = cores > 1 ? cores - 1 : 0;
+	}
+
+	// Main thread's queue, then one per worker
+	for (int i = 0; i <= numWorkers; i++)
+	{
+		mQueues.emplace_back(new WorkQueue());
+	}
+
+	mRunning = true;
+	for (int i = 1; i <= numWorkers; i++)
+	{
+		mThreads.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mRunning = false;
+	}
+	mWakeCond.notify_all();
+	for (auto& t : mThreads)
+	{
+		t.join();
+	}
+	mThreads.clear();
+
+	for (auto q : mQueues)
+	{
+		delete q;
+	}
+	mQueues.clear();
+}
+
+void JobSystem::Run(Job job, JobCounter* counter)
+{
+	if (counter)
+	{
+		counter->mValue++;
+	}
+
+	// Goes on the queue of whichever thread queued it
+	WorkQueue* queue = mQueues[sThreadIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue->mMutex);
+		queue->mJobs.push_back(JobEntry{ std::move(job), counter });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mQueuedJobs++;
+	}
+	mWakeCond.notify_one();
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+	while (counter->mValue.load() > 0)
+	{
+		// Help out instead of blocking
+		if (!TryRunJob(sThreadIndex))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize,
+	const std::function<void(size_t, size_t)>& func)
+{
+	if (grainSize == 0)
+	{
+		grainSize = 1;
+	}
+
+	// Not worth the overhead for a single chunk (or with no workers)
+	if (count <= grainSize || mThreads.empty())
+	{
+		if (count > 0)
+		{
+			func(0, count);
+		}
+		return;
+	}
+
+	JobCounter counter;
+	for (size_t begin = 0; begin < count; begin += grainSize)
+	{
+		size_t end = begin + grainSize < count ? begin + grainSize : count;
+		Run([&func, begin, end]() { func(begin, end); }, &counter);
+	}
+	Wait(&counter);
+}
+
+void JobSystem::WorkerLoop(int threadIndex)
+{
+	sThreadIndex = threadIndex;
+	while (true)
+	{
+		if (TryRunJob(threadIndex))
+		{
+			continue;
+		}
+
+		// Nothing to do, so sleep until something is queued
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mWakeCond.wait(lock, [this]() {
+			return mQueuedJobs.load() > 0 || !mRunning;
+		});
+		if (!mRunning)
+		{
+			return;
+		}
+	}
+}
+
+bool JobSystem::TryRunJob(int threadIndex)
+{
+	JobEntry entry;
+	if (!PopJob(threadIndex, entry))
+	{
+		return false;
+	}
+
+	mQueuedJobs--;
+	{
+		PROFILE_SCOPE("Job");
+		entry.mJob();
+	}
+	if (entry.mCounter)
+	{
+		entry.mCounter->mValue--;
+	}
+	return true;
+}
+
+bool JobSystem::PopJob(int threadIndex, JobEntry& outEntry)
+{
+	// Newest job from our own queue (its data is most likely in cache)
+	WorkQueue* own = mQueues[threadIndex];
+	{
+		std::lock_guard<std::mutex> lock(own->mMutex);
+		if (!own->mJobs.empty())
+		{
+			outEntry = std::move(own->mJobs.back());
+			own->mJobs.pop_back();
+			return true;
+		}
+	}
+
+	// Otherwise steal the oldest job from someone else
+	size_t numQueues = mQueues.size();
+	for (size_t i = 1; i < numQueues; i++)
+	{
+		WorkQueue* victim = mQueues[(threadIndex + i) % numQueues];
+		std::lock_guard<std::mutex> lock(victim->mMutex);
+		if (!victim->mJobs.empty())
+		{
+			outEntry = std::move(victim->mJobs.front());
+			victim->mJobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
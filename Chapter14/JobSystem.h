@@ -0,0 +1,85 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts unfinished jobs. Jobs started with a counter increment it,
+// and decrement it when done, so waiting on it waits for all of them
+// (this is also how one batch of jobs can depend on another).
+struct JobCounter
+{
+	std::atomic<int> mValue{ 0 };
+};
+
+// Worker threads that run jobs. Each thread has its own queue, and
+// takes the newest job from it; a thread that runs out steals the
+// oldest job from another thread's queue.
+class JobSystem
+{
+public:
+	using Job = std::function<void()>;
+
+	JobSystem();
+	~JobSystem();
+
+	// Start the workers (-1 means one per core, minus the main thread;
+	// 0 runs every job on the main thread when it waits)
+	void Initialize(int numWorkers = -1);
+	void Shutdown();
+
+	// Queue a job (the counter, if any, tracks when it finishes)
+	void Run(Job job, JobCounter* counter = nullptr);
+	// Wait for the counter to reach zero. The calling thread runs
+	// queued jobs while it waits, rather than sleeping.
+	void Wait(JobCounter* counter);
+
+	// Call func(begin, end) over [0, count) in chunks of grainSize,
+	// spread over all threads. Returns once every chunk is done.
+	void ParallelFor(size_t count, size_t grainSize,
+		const std::function<void(size_t, size_t)>& func);
+
+	// Threads that run jobs (workers plus the main thread)
+	int GetNumThreads() const { return static_cast<int>(mQueues.size()); }
+	// Index of the calling thread (0 is the main thread)
+	static int GetThreadIndex() { return sThreadIndex; }
+private:
+	struct JobEntry
+	{
+		Job mJob;
+		JobCounter* mCounter;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mMutex;
+		std::deque<JobEntry> mJobs;
+	};
+
+	void WorkerLoop(int threadIndex);
+	// Run one job from this thread's queue, or stolen from another
+	bool TryRunJob(int threadIndex);
+	bool PopJob(int threadIndex, JobEntry& outEntry);
+
+	std::vector<std::thread> mThreads;
+	// One queue per thread (index 0 for the main thread)
+	std::vector<WorkQueue*> mQueues;
+	// Workers sleep on this when there's nothing queued
+	std::mutex mWakeMutex;
+	std::condition_variable mWakeCond;
+	std::atomic<int> mQueuedJobs;
+	std::atomic<bool> mRunning;
+
+	static thread_local int sThreadIndex;
+};
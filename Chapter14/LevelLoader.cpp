@@ -30,6 +30,8 @@
 #include "MirrorCamera.h"
 #include "PointLightComponent.h"
 #include "TargetComponent.h"
+#include "RigidBodyComponent.h"
+#include "ObjectPool.h"
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/prettywriter.h>
 
@@ -59,6 +61,7 @@ std::unordered_map<std::string, std::pair<int, ComponentFunc>> LevelLoader::sCom
 	{ "MirrorCamera", { Component::TMirrorCamera, &Component::Create<MirrorCamera> } },
 	{ "PointLightComponent", { Component::TPointLightComponent, &Component::Create<PointLightComponent> }},
 	{ "TargetComponent",{ Component::TTargetComponent, &Component::Create<TargetComponent> } },
+	{ "RigidBodyComponent", { Component::TRigidBodyComponent, &Component::Create<RigidBodyComponent> } },
 };
 
 bool LevelLoader::LoadLevel(Game* game, const std::string& fileName)
@@ -86,10 +89,13 @@ bool LevelLoader::LoadLevel(Game* game, const std::string& fileName)
 	}
 
 	// Handle any actors
+	// (these all go in the level arena, so unloading frees them at once)
 	const rapidjson::Value& actors = doc["actors"];
 	if (actors.IsArray())
 	{
+		ObjectAllocator::SetUseLevelArena(true);
 		LoadActors(game, actors);
+		ObjectAllocator::SetUseLevelArena(false);
 	}
 	return true;
 }
@@ -7,14 +7,88 @@
 // ----------------------------------------------------------------
 
 #include "Game.h"
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include "Profiler.h"
+#include "PhysBenchmark.h"
 
 int main(int argc, char** argv)
 {
 	Game game;
+
+	// Command line options:
+	// -headless     No window/GL/audio, run ticks as fast as possible
+	// -ticks N      Quit after N simulation ticks
+	// -tickrate N   Simulation ticks per second (default 60)
+	// -fps N        Cap frames per second (headless: tick in real time)
+	// -threads N    Job system worker threads (default one per core)
+	// -profile F    Profile from the start, and save a Chrome trace to F
+	// -record F     Record each tick's input to F
+	// -replay F     Replay the input recorded in F (runs headless)
+	// -benchphys F  Benchmark the physics world on synthetic scenes
+	//               instead of playing, and save results to F (.csv/.json)
+	std::string profileFile;
+	std::string benchFile;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-headless") == 0)
+		{
+			game.SetHeadless(true);
+		}
+		else if (strcmp(argv[i], "-ticks") == 0 && i + 1 < argc)
+		{
+			game.SetTickLimit(strtoull(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "-tickrate") == 0 && i + 1 < argc)
+		{
+			game.SetTickRate(static_cast<float>(atof(argv[++i])));
+		}
+		else if (strcmp(argv[i], "-fps") == 0 && i + 1 < argc)
+		{
+			game.SetMaxFrameRate(static_cast<float>(atof(argv[++i])));
+		}
+		else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+		{
+			game.SetNumWorkers(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "-record") == 0 && i + 1 < argc)
+		{
+			game.SetRecordFile(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc)
+		{
+			game.SetReplayFile(argv[++i]);
+			game.SetHeadless(true);
+		}
+		else if (strcmp(argv[i], "-profile") == 0 && i + 1 < argc)
+		{
+			profileFile = argv[++i];
+			Profiler::SetEnabled(true);
+		}
+		else if (strcmp(argv[i], "-benchphys") == 0 && i + 1 < argc)
+		{
+			benchFile = argv[++i];
+			game.SetHeadless(true);
+		}
+	}
+
 	bool success = game.Initialize();
 	if (success)
 	{
-		game.RunLoop();
+		if (!benchFile.empty())
+		{
+			PhysBenchmark bench(&game);
+			bench.Run(benchFile);
+		}
+		else
+		{
+			game.RunLoop();
+		}
+		if (!profileFile.empty())
+		{
+			Profiler::WriteChromeTrace(profileFile);
+		}
 	}
 	game.Shutdown();
 	return 0;
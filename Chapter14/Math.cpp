@@ -237,3 +237,32 @@ Matrix4 Matrix4::CreateFromQuaternion(const class Quaternion& q)
 
 	return Matrix4(mat);
 }
+
+Matrix4 Matrix4::CreateFromTRS(const Vector3& trans, const Quaternion& q, float scale)
+{
+	float mat[4][4];
+
+	// Rotation rows, each multiplied by the (uniform) scale
+	mat[0][0] = scale * (1.0f - 2.0f * q.y * q.y - 2.0f * q.z * q.z);
+	mat[0][1] = scale * (2.0f * q.x * q.y + 2.0f * q.w * q.z);
+	mat[0][2] = scale * (2.0f * q.x * q.z - 2.0f * q.w * q.y);
+	mat[0][3] = 0.0f;
+
+	mat[1][0] = scale * (2.0f * q.x * q.y - 2.0f * q.w * q.z);
+	mat[1][1] = scale * (1.0f - 2.0f * q.x * q.x - 2.0f * q.z * q.z);
+	mat[1][2] = scale * (2.0f * q.y * q.z + 2.0f * q.w * q.x);
+	mat[1][3] = 0.0f;
+
+	mat[2][0] = scale * (2.0f * q.x * q.z + 2.0f * q.w * q.y);
+	mat[2][1] = scale * (2.0f * q.y * q.z - 2.0f * q.w * q.x);
+	mat[2][2] = scale * (1.0f - 2.0f * q.x * q.x - 2.0f * q.y * q.y);
+	mat[2][3] = 0.0f;
+
+	// Translation row
+	mat[3][0] = trans.x;
+	mat[3][1] = trans.y;
+	mat[3][2] = trans.z;
+	mat[3][3] = 1.0f;
+
+	return Matrix4(mat);
+}
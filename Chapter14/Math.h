@@ -789,6 +789,11 @@ public:
 	// Create a rotation matrix from a quaternion
 	static Matrix4 CreateFromQuaternion(const class Quaternion& q);
 
+	// Same as CreateScale(scale) * CreateFromQuaternion(rot) *
+	// CreateTranslation(trans), but built directly
+	static Matrix4 CreateFromTRS(const Vector3& trans,
+		const class Quaternion& rot, float scale);
+
 	static Matrix4 CreateTranslation(const Vector3& trans)
 	{
 		float temp[4][4] =
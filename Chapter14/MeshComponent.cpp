@@ -16,44 +16,112 @@
 #include "VertexArray.h"
 #include "LevelLoader.h"
 
+namespace
+{
+	// Animation can move a skinned mesh outside of its bind pose
+	// bounds, so those are grown by this much
+	const float SkinnedBoundsScale = 1.5f;
+
+	// Set for every mesh drawn, so hash the names once
+	const UniformName WorldTransformName("uWorldTransform");
+	const UniformName SpecPowerName("uSpecPower");
+}
+
 MeshComponent::MeshComponent(Actor* owner, bool isSkeletal)
 	:Component(owner)
 	,mMesh(nullptr)
+	,mWorldSphere(Vector3::Zero, 0.0f)
+	,mWorldBox(Vector3::Zero, Vector3::Zero)
 	,mTextureIndex(0)
 	,mVisible(true)
 	,mIsSkeletal(isSkeletal)
 {
-	mOwner->GetGame()->GetRenderer()->AddMeshComp(this);
+	mRenderHandle = mOwner->GetGame()->GetRenderer()->AddMeshComp(this);
 }
 
 MeshComponent::~MeshComponent()
 {
-	mOwner->GetGame()->GetRenderer()->RemoveMeshComp(this);
+	mOwner->GetGame()->GetRenderer()->RemoveMeshComp(mRenderHandle, mIsSkeletal);
 }
 
 void MeshComponent::Draw(Shader* shader)
 {
 	if (mMesh)
 	{
-		// Set the world transform
-		shader->SetMatrixUniform("uWorldTransform", 
-			mOwner->GetWorldTransform());
-		// Set specular power
-		shader->SetFloatUniform("uSpecPower", mMesh->GetSpecPower());
+		SetDrawUniforms(shader);
 		// Set the active texture
-		Texture* t = mMesh->GetTexture(mTextureIndex);
+		Texture* t = GetTexture();
 		if (t)
 		{
 			t->SetActive();
 		}
 		// Set the mesh's vertex array as active
-		VertexArray* va = mMesh->GetVertexArray();
+		VertexArray* va = GetVertexArray();
 		va->SetActive();
 		// Draw
 		glDrawElements(GL_TRIANGLES, va->GetNumIndices(), GL_UNSIGNED_INT, nullptr);
 	}
 }
 
+void MeshComponent::SetDrawUniforms(Shader* shader)
+{
+	// Set the world transform
+	shader->SetMatrixUniform(WorldTransformName, 
+		mOwner->GetRenderTransform());
+	// Set specular power
+	shader->SetFloatUniform(SpecPowerName, mMesh->GetSpecPower());
+}
+
+Texture* MeshComponent::GetTexture() const
+{
+	return mMesh ? mMesh->GetTexture(mTextureIndex) : nullptr;
+}
+
+VertexArray* MeshComponent::GetVertexArray() const
+{
+	return mMesh ? mMesh->GetVertexArray() : nullptr;
+}
+
+void MeshComponent::SetMesh(Mesh* mesh)
+{
+	mMesh = mesh;
+	UpdateWorldBounds();
+}
+
+void MeshComponent::OnUpdateWorldTransform()
+{
+	UpdateWorldBounds();
+}
+
+void MeshComponent::UpdateWorldBounds()
+{
+	if (!mMesh)
+	{
+		return;
+	}
+
+	// Sphere around the object's origin, and the box like BoxComponent's
+	float scale = mOwner->GetWorldScale();
+	Vector3 pos = mOwner->GetWorldPosition();
+	float radius = mMesh->GetRadius() * scale;
+	mWorldBox = mMesh->GetBox();
+	mWorldBox.mMin *= scale;
+	mWorldBox.mMax *= scale;
+	if (mIsSkeletal)
+	{
+		radius *= SkinnedBoundsScale;
+		Vector3 center = (mWorldBox.mMin + mWorldBox.mMax) * 0.5f;
+		Vector3 extents = (mWorldBox.mMax - mWorldBox.mMin) * (0.5f * SkinnedBoundsScale);
+		mWorldBox.mMin = center - extents;
+		mWorldBox.mMax = center + extents;
+	}
+	mWorldBox.Rotate(mOwner->GetWorldRotation());
+	mWorldBox.mMin += pos;
+	mWorldBox.mMax += pos;
+	mWorldSphere.mCenter = pos;
+	mWorldSphere.mRadius = radius;
+}
+
 void MeshComponent::LoadProperties(const rapidjson::Value& inObj)
 {
 	Component::LoadProperties(inObj);
@@ -71,7 +139,17 @@ void MeshComponent::LoadProperties(const rapidjson::Value& inObj)
 	}
 
 	JsonHelper::GetBool(inObj, "visible", mVisible);
-	JsonHelper::GetBool(inObj, "isSkeletal", mIsSkeletal);
+
+	bool isSkeletal = mIsSkeletal;
+	JsonHelper::GetBool(inObj, "isSkeletal", isSkeletal);
+	if (isSkeletal != mIsSkeletal)
+	{
+		// The renderer keeps skeletal meshes separately, so move over
+		Renderer* renderer = mOwner->GetGame()->GetRenderer();
+		renderer->RemoveMeshComp(mRenderHandle, mIsSkeletal);
+		mIsSkeletal = isSkeletal;
+		mRenderHandle = renderer->AddMeshComp(this);
+	}
 }
 
 void MeshComponent::SaveProperties(rapidjson::Document::AllocatorType& alloc, rapidjson::Value& inObj) const
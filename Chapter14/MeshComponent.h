@@ -8,6 +8,8 @@
 
 #pragma once
 #include "Component.h"
+#include "SlotMap.h"
+#include "Collision.h"
 
 class MeshComponent : public Component
 {
@@ -15,15 +17,28 @@ public:
 	MeshComponent(class Actor* owner, bool isSkeletal = false);
 	~MeshComponent();
 	// Draw this mesh component
-	virtual void Draw(class Shader* shader);
+	void Draw(class Shader* shader);
+	// The parts of Draw, for the render queue (which binds the texture
+	// and vertex array itself, only when they change)
+	virtual void SetDrawUniforms(class Shader* shader);
+	class Texture* GetTexture() const;
+	class VertexArray* GetVertexArray() const;
+	class Mesh* GetMesh() const { return mMesh; }
 	// Set the mesh/texture index used by mesh component
-	virtual void SetMesh(class Mesh* mesh) { mMesh = mesh; }
+	virtual void SetMesh(class Mesh* mesh);
 	void SetTextureIndex(size_t index) { mTextureIndex = index; }
 
 	void SetVisible(bool visible) { mVisible = visible; }
 	bool GetVisible() const { return mVisible; }
 
 	bool GetIsSkeletal() const { return mIsSkeletal; }
+	bool GetHasMesh() const { return mMesh != nullptr; }
+
+	// The mesh's bounds in world space (for culling), updated when the
+	// owner moves
+	void OnUpdateWorldTransform() override;
+	const Sphere& GetWorldSphere() const { return mWorldSphere; }
+	const AABB& GetWorldBox() const { return mWorldBox; }
 
 	TypeID GetType() const override { return TMeshComponent; }
 
@@ -31,8 +46,14 @@ public:
 	void SaveProperties(rapidjson::Document::AllocatorType& alloc,
 		rapidjson::Value& inObj) const override;
 protected:
+	void UpdateWorldBounds();
+
 	class Mesh* mMesh;
+	Sphere mWorldSphere;
+	AABB mWorldBox;
 	size_t mTextureIndex;
 	bool mVisible;
 	bool mIsSkeletal;
+	// Handle in the renderer's (skeletal) mesh components
+	SlotHandle mRenderHandle;
 };
\ No newline at end of file
@@ -15,6 +15,8 @@ public:
 	// Lower update order to update first
 	MoveComponent(class Actor* owner, int updateOrder = 10);
 	void Update(float deltaTime) override;
+	// Only moves the owner
+	bool GetIsThreadSafe() const override { return true; }
 	
 	float GetAngularSpeed() const { return mAngularSpeed; }
 	float GetForwardSpeed() const { return mForwardSpeed; }
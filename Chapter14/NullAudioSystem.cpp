@@ -0,0 +1,71 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "NullAudioSystem.h"
+
+NullAudioSystem::NullAudioSystem(Game* game)
+	:AudioSystem(game)
+{
+}
+
+NullAudioSystem::~NullAudioSystem()
+{
+}
+
+bool NullAudioSystem::Initialize()
+{
+	return true;
+}
+
+void NullAudioSystem::Shutdown()
+{
+}
+
+void NullAudioSystem::LoadBank(const std::string& name)
+{
+}
+
+void NullAudioSystem::UnloadBank(const std::string& name)
+{
+}
+
+void NullAudioSystem::UnloadAllBanks()
+{
+}
+
+SoundEvent NullAudioSystem::PlayEvent(const std::string& name)
+{
+	// A default SoundEvent is never valid, so calls on it do nothing
+	return SoundEvent();
+}
+
+void NullAudioSystem::Update(float deltaTime)
+{
+}
+
+void NullAudioSystem::SetListener(const Matrix4& viewMatrix)
+{
+}
+
+float NullAudioSystem::GetBusVolume(const std::string& name) const
+{
+	return 0.0f;
+}
+
+bool NullAudioSystem::GetBusPaused(const std::string& name) const
+{
+	return false;
+}
+
+void NullAudioSystem::SetBusVolume(const std::string& name, float volume)
+{
+}
+
+void NullAudioSystem::SetBusPaused(const std::string& name, bool pause)
+{
+}
@@ -0,0 +1,36 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include "AudioSystem.h"
+
+// Audio system for headless runs: never touches FMOD,
+// and every event it plays is invalid
+class NullAudioSystem : public AudioSystem
+{
+public:
+	NullAudioSystem(class Game* game);
+	~NullAudioSystem();
+
+	bool Initialize() override;
+	void Shutdown() override;
+
+	void LoadBank(const std::string& name) override;
+	void UnloadBank(const std::string& name) override;
+	void UnloadAllBanks() override;
+
+	SoundEvent PlayEvent(const std::string& name) override;
+
+	void Update(float deltaTime) override;
+
+	void SetListener(const Matrix4& viewMatrix) override;
+	float GetBusVolume(const std::string& name) const override;
+	bool GetBusPaused(const std::string& name) const override;
+	void SetBusVolume(const std::string& name, float volume) override;
+	void SetBusPaused(const std::string& name, bool pause) override;
+};
@@ -0,0 +1,66 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "NullRenderer.h"
+#include "Texture.h"
+
+NullRenderer::NullRenderer(Game* game)
+	:Renderer(game)
+{
+}
+
+NullRenderer::~NullRenderer()
+{
+}
+
+bool NullRenderer::Initialize(float screenWidth, float screenHeight)
+{
+	mScreenWidth = screenWidth;
+	mScreenHeight = screenHeight;
+
+	// Still need view/projection, so Unproject (used for aiming) works
+	mView = Matrix4::CreateLookAt(Vector3::Zero, Vector3::UnitX, Vector3::UnitZ);
+	mProjection = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
+		mScreenWidth, mScreenHeight, 10.0f, 10000.0f);
+	return true;
+}
+
+void NullRenderer::Shutdown()
+{
+	// Nothing was created on the GPU
+}
+
+void NullRenderer::Draw()
+{
+	// Nothing to draw to
+}
+
+Texture* NullRenderer::GetTexture(const std::string& fileName)
+{
+	Texture* tex = nullptr;
+	auto iter = mTextures.find(fileName);
+	if (iter != mTextures.end())
+	{
+		tex = iter->second;
+	}
+	else
+	{
+		// Only read the image size (sprites need it), no GL texture
+		tex = new Texture();
+		if (tex->LoadHeadless(fileName))
+		{
+			mTextures.emplace(fileName, tex);
+		}
+		else
+		{
+			delete tex;
+			tex = nullptr;
+		}
+	}
+	return tex;
+}
@@ -0,0 +1,28 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include "Renderer.h"
+
+// Renderer for headless runs: no window or GL context, and
+// assets only load what the simulation needs
+class NullRenderer : public Renderer
+{
+public:
+	NullRenderer(class Game* game);
+	~NullRenderer();
+
+	bool Initialize(float screenWidth, float screenHeight) override;
+	void Shutdown() override;
+
+	void Draw() override;
+
+	class Texture* GetTexture(const std::string& fileName) override;
+
+	bool GetIsHeadless() const override { return true; }
+};
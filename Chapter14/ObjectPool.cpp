@@ -0,0 +1,263 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "ObjectPool.h"
+#include <cstdlib>
+#include <new>
+#include <SDL/SDL_log.h>
+
+namespace
+{
+	// Every object is preceded by a header saying where it came from,
+	// padded so the object itself stays 16-byte aligned
+	enum AllocSource
+	{
+		ESourceHeap,
+		ESourcePool,
+		ESourceArena
+	};
+
+	struct alignas(16) AllocHeader
+	{
+		AllocSource mSource;
+		// Index of the pool (if from a pool)
+		unsigned int mPoolIndex;
+	};
+
+	const size_t PoolGranularity = 16;
+	// Objects bigger than this just use the heap
+	const size_t MaxPooledSize = 8192;
+	const size_t BlocksPerChunk = 64;
+	const size_t ArenaChunkSize = 256 * 1024;
+
+	size_t RoundUp(size_t size, size_t align)
+	{
+		return (size + align - 1) & ~(align - 1);
+	}
+}
+
+ObjectPool::ObjectPool(size_t blockSize, size_t blocksPerChunk)
+	:mFreeList(nullptr)
+	,mBlockSize(RoundUp(blockSize < sizeof(void*) ? sizeof(void*) : blockSize, PoolGranularity))
+	,mBlocksPerChunk(blocksPerChunk)
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+	for (auto chunk : mChunks)
+	{
+		free(chunk);
+	}
+}
+
+void* ObjectPool::Allocate()
+{
+	if (mFreeList == nullptr)
+	{
+		AddChunk();
+	}
+	void* block = mFreeList;
+	mFreeList = *static_cast<void**>(block);
+	return block;
+}
+
+void ObjectPool::Free(void* ptr)
+{
+	*static_cast<void**>(ptr) = mFreeList;
+	mFreeList = ptr;
+}
+
+void ObjectPool::AddChunk()
+{
+	char* chunk = static_cast<char*>(malloc(mBlockSize * mBlocksPerChunk));
+	if (chunk == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	mChunks.emplace_back(chunk);
+
+	// Thread the new blocks onto the free list (in order, so
+	// consecutive allocations are next to each other in memory)
+	for (size_t i = mBlocksPerChunk; i > 0; i--)
+	{
+		void* block = chunk + (i - 1) * mBlockSize;
+		*static_cast<void**>(block) = mFreeList;
+		mFreeList = block;
+	}
+}
+
+LevelArena::LevelArena(size_t chunkSize)
+	:mCurrent(nullptr)
+	,mRemaining(0)
+	,mChunkSize(chunkSize)
+	,mBytesReserved(0)
+{
+}
+
+LevelArena::~LevelArena()
+{
+	Reset();
+}
+
+void* LevelArena::Allocate(size_t size)
+{
+	size = RoundUp(size, PoolGranularity);
+	if (size > mRemaining)
+	{
+		// Start a new chunk (big enough for this, at least)
+		size_t chunkSize = size > mChunkSize ? size : mChunkSize;
+		char* chunk = static_cast<char*>(malloc(chunkSize));
+		if (chunk == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		mChunks.emplace_back(chunk);
+		mBytesReserved += chunkSize;
+		mCurrent = chunk;
+		mRemaining = chunkSize;
+	}
+	void* ptr = mCurrent;
+	mCurrent += size;
+	mRemaining -= size;
+	return ptr;
+}
+
+void LevelArena::Reset()
+{
+	for (auto chunk : mChunks)
+	{
+		free(chunk);
+	}
+	mChunks.clear();
+	mCurrent = nullptr;
+	mRemaining = 0;
+	mBytesReserved = 0;
+}
+
+std::vector<ObjectPool*> ObjectAllocator::sPools;
+LevelArena ObjectAllocator::sLevelArena(ArenaChunkSize);
+bool ObjectAllocator::sUseLevelArena = false;
+ObjectAllocStats ObjectAllocator::sStats;
+
+void* ObjectAllocator::Allocate(size_t size)
+{
+	size_t total = size + sizeof(AllocHeader);
+	AllocHeader* header = nullptr;
+	if (sUseLevelArena)
+	{
+		header = static_cast<AllocHeader*>(sLevelArena.Allocate(total));
+		header->mSource = ESourceArena;
+		header->mPoolIndex = 0;
+		sStats.mArenaAllocs++;
+		sStats.mLiveArenaObjects++;
+	}
+	else if (total <= MaxPooledSize)
+	{
+		// One pool per 16-byte size class, made on first use
+		size_t index = RoundUp(total, PoolGranularity) / PoolGranularity;
+		if (index >= sPools.size())
+		{
+			sPools.resize(index + 1, nullptr);
+		}
+		if (sPools[index] == nullptr)
+		{
+			sPools[index] = new ObjectPool(index * PoolGranularity, BlocksPerChunk);
+		}
+		header = static_cast<AllocHeader*>(sPools[index]->Allocate());
+		header->mSource = ESourcePool;
+		header->mPoolIndex = static_cast<unsigned int>(index);
+		sStats.mPoolAllocs++;
+	}
+	else
+	{
+		header = static_cast<AllocHeader*>(malloc(total));
+		if (header == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		header->mSource = ESourceHeap;
+		header->mPoolIndex = 0;
+		sStats.mHeapAllocs++;
+	}
+
+	sStats.mLiveObjects++;
+	if (sStats.mLiveObjects > sStats.mPeakLiveObjects)
+	{
+		sStats.mPeakLiveObjects = sStats.mLiveObjects;
+	}
+	return header + 1;
+}
+
+void ObjectAllocator::Free(void* ptr)
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	AllocHeader* header = static_cast<AllocHeader*>(ptr) - 1;
+	switch (header->mSource)
+	{
+	case ESourcePool:
+		sPools[header->mPoolIndex]->Free(header);
+		break;
+	case ESourceArena:
+		// Arena memory comes back all at once, in ResetLevelArena
+		sStats.mLiveArenaObjects--;
+		break;
+	default:
+		free(header);
+		break;
+	}
+	sStats.mLiveObjects--;
+}
+
+void ObjectAllocator::ResetLevelArena()
+{
+	if (sStats.mLiveArenaObjects > 0)
+	{
+		// Resetting now would pull memory out from under live objects,
+		// so hold onto it instead (leaking is better than corrupting)
+		SDL_Log("Not resetting level arena: %u objects still alive",
+			static_cast<unsigned>(sStats.mLiveArenaObjects));
+		return;
+	}
+	sLevelArena.Reset();
+	sStats.mArenaResets++;
+}
+
+const ObjectAllocStats& ObjectAllocator::GetStats()
+{
+	sStats.mPoolBytesReserved = 0;
+	for (auto pool : sPools)
+	{
+		if (pool)
+		{
+			sStats.mPoolBytesReserved += pool->GetBytesReserved();
+		}
+	}
+	sStats.mArenaBytesReserved = sLevelArena.GetBytesReserved();
+	return sStats;
+}
+
+void ObjectAllocator::Shutdown()
+{
+	if (sStats.mLiveObjects > 0)
+	{
+		SDL_Log("Not releasing object pools: %u objects still alive",
+			static_cast<unsigned>(sStats.mLiveObjects));
+		return;
+	}
+	for (auto pool : sPools)
+	{
+		delete pool;
+	}
+	sPools.clear();
+	ResetLevelArena();
+}
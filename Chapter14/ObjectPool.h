@@ -0,0 +1,99 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Hands out fixed-size blocks from big chunks, recycling
+// freed blocks through a free list
+class ObjectPool
+{
+public:
+	ObjectPool(size_t blockSize, size_t blocksPerChunk);
+	~ObjectPool();
+
+	void* Allocate();
+	void Free(void* ptr);
+
+	size_t GetBlockSize() const { return mBlockSize; }
+	size_t GetBytesReserved() const { return mChunks.size() * mBlockSize * mBlocksPerChunk; }
+private:
+	void AddChunk();
+
+	std::vector<char*> mChunks;
+	// Free blocks link to the next free block through their first bytes
+	void* mFreeList;
+	size_t mBlockSize;
+	size_t mBlocksPerChunk;
+};
+
+// Bump allocator for everything a level loads. Individual frees
+// are ignored; the whole arena is reset at once when the level unloads.
+class LevelArena
+{
+public:
+	LevelArena(size_t chunkSize);
+	~LevelArena();
+
+	void* Allocate(size_t size);
+	// Release everything (only once nothing allocated here is alive)
+	void Reset();
+
+	size_t GetBytesReserved() const { return mBytesReserved; }
+private:
+	std::vector<char*> mChunks;
+	char* mCurrent;
+	size_t mRemaining;
+	size_t mChunkSize;
+	size_t mBytesReserved;
+};
+
+// Allocation counters for actors/components
+struct ObjectAllocStats
+{
+	// Objects alive right now (and the most ever alive at once)
+	size_t mLiveObjects = 0;
+	size_t mPeakLiveObjects = 0;
+	// Of those alive, how many are in the level arena
+	size_t mLiveArenaObjects = 0;
+	// Total allocations from each source
+	size_t mPoolAllocs = 0;
+	size_t mArenaAllocs = 0;
+	size_t mHeapAllocs = 0;
+	// Memory held by the pools/arena
+	size_t mPoolBytesReserved = 0;
+	size_t mArenaBytesReserved = 0;
+	// Number of times the level arena was reset
+	size_t mArenaResets = 0;
+};
+
+// Memory for actors/components (used by their operator new/delete).
+// Objects come from a pool per 16-byte size class (shared by every
+// type that rounds up to that size), or from the level arena while a
+// level is loading.
+class ObjectAllocator
+{
+public:
+	static void* Allocate(size_t size);
+	static void Free(void* ptr);
+
+	// While set, allocations go to the level arena
+	static void SetUseLevelArena(bool use) { sUseLevelArena = use; }
+	// Call after all of the level's objects are deleted
+	static void ResetLevelArena();
+
+	static const ObjectAllocStats& GetStats();
+	// Release pool memory (only once all objects are deleted)
+	static void Shutdown();
+private:
+	static std::vector<ObjectPool*> sPools;
+	static LevelArena sLevelArena;
+	static bool sUseLevelArena;
+	static ObjectAllocStats sStats;
+};
@@ -0,0 +1,452 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "PhysBenchmark.h"
+#include "Game.h"
+#include "Actor.h"
+#include "BoxComponent.h"
+#include "RigidBodyComponent.h"
+#include "PhysWorld.h"
+#include "TransformSystem.h"
+#include "CommandBuffer.h"
+#include "Random.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/prettywriter.h>
+#include <SDL/SDL_log.h>
+
+namespace
+{
+	const char* SceneNames[] = { "uniform", "clustered", "moving", "mostly_static",
+		"stacks" };
+	const int SceneSizes[] = { 100, 1000, 10000, 100000 };
+	const unsigned int SceneSeed = 1234;
+	// Each test runs once per frame (the moving scenes move in between)
+	const int NumFrames = 10;
+	const int NumSegments = 1000;
+	// Naive pairwise is O(n^2), so skip it past this many boxes
+	const int MaxPairwiseBoxes = 10000;
+	// Average spacing between boxes (so density is the same at any size)
+	const float BoxSpacing = 100.0f;
+	const float MinHalfSize = 5.0f;
+	const float MaxHalfSize = 25.0f;
+	const int BoxesPerCluster = 200;
+	const float ClusterRadius = 150.0f;
+	const float MaxSpeed = 100.0f;
+	// Fraction of the boxes that move in the mostly static scene
+	const float MovingFraction = 0.05f;
+	// Every stack is its own island, so this many islands settle at once
+	const int StackHeight = 4;
+	const float StackHalfSize = 25.0f;
+	// Gap between neighboring stacks
+	const float StackGap = 50.0f;
+	// Up to 0.5 cm out of line, so the stacks aren't perfectly neat
+	const float StackJitter = 0.5f;
+	// Steps to run (long enough for all of them to fall asleep)
+	const int NumSettleFrames = 180;
+	// Every body is simulated until it sleeps, so skip the biggest sizes
+	const int MaxStackBoxes = 10000;
+}
+
+PhysBenchmark::PhysBenchmark(Game* game)
+	:mGame(game)
+	,mWorldSize(0.0f)
+{
+}
+
+bool PhysBenchmark::Run(const std::string& fileName)
+{
+	// The level's actors would skew every result
+	mGame->SetFollowActor(nullptr);
+	ClearScene();
+
+	for (int type = 0; type < NUM_SCENE_TYPES; type++)
+	{
+		for (int numBoxes : SceneSizes)
+		{
+			if (type == EStacks)
+			{
+				if (numBoxes <= MaxStackBoxes)
+				{
+					RunStacks(numBoxes);
+				}
+			}
+			else
+			{
+				RunScene(static_cast<SceneType>(type), numBoxes);
+			}
+		}
+	}
+
+	size_t len = fileName.size();
+	if (len >= 5 && fileName.compare(len - 5, 5, ".json") == 0)
+	{
+		return WriteJSON(fileName);
+	}
+	return WriteCSV(fileName);
+}
+
+void PhysBenchmark::RunScene(SceneType type, int numBoxes)
+{
+	PhysWorld* phys = mGame->GetPhysWorld();
+	Random::Seed(SceneSeed);
+
+	// Building includes the first pair test, since that's when the sweep
+	// and prune adds the new boxes
+	size_t count = 0;
+	auto countPair = [&count](Actor*, Actor*) { count++; };
+	uint64_t start = Profiler::GetTimeNs();
+	CreateScene(type, numBoxes);
+	FlushTransforms();
+	phys->TestSweepAndPrune(countPair);
+	AddResult(type, numBoxes, "Build", Profiler::GetTimeNs() - start, 1, numBoxes,
+		count, phys->GetTreeMemoryUsage() + phys->GetSAPMemoryUsage());
+
+	std::vector<LineSegment> segments;
+	segments.reserve(NumSegments);
+	for (int i = 0; i < NumSegments; i++)
+	{
+		Vector3 segStart = Random::GetVector(Vector3::Zero,
+			Vector3(mWorldSize, mWorldSize, mWorldSize));
+		float reach = mWorldSize * 0.25f;
+		Vector3 offset = Random::GetVector(Vector3(-reach, -reach, -reach),
+			Vector3(reach, reach, reach));
+		segments.emplace_back(segStart, segStart + offset);
+	}
+	std::vector<PhysWorld::CollisionInfo> castInfo(NumSegments);
+	std::vector<PhysWorld::CollisionInfo> batchInfo;
+
+	uint64_t updateNs = 0;
+	uint64_t pairwiseNs = 0;
+	uint64_t sapNs = 0;
+	uint64_t treeNs = 0;
+	uint64_t castNs = 0;
+	uint64_t batchNs = 0;
+	size_t pairwiseCount = 0;
+	size_t sapCount = 0;
+	size_t treeCount = 0;
+	size_t castHits = 0;
+	size_t batchHits = 0;
+	size_t numDifferent = 0;
+	for (int frame = 0; frame < NumFrames; frame++)
+	{
+		if (!mMovers.empty())
+		{
+			MoveBoxes();
+			start = Profiler::GetTimeNs();
+			FlushTransforms();
+			updateNs += Profiler::GetTimeNs() - start;
+		}
+
+		if (numBoxes <= MaxPairwiseBoxes)
+		{
+			count = 0;
+			start = Profiler::GetTimeNs();
+			phys->TestPairwise(countPair);
+			pairwiseNs += Profiler::GetTimeNs() - start;
+			pairwiseCount = count;
+		}
+
+		count = 0;
+		start = Profiler::GetTimeNs();
+		phys->TestSweepAndPrune(countPair);
+		sapNs += Profiler::GetTimeNs() - start;
+		sapCount = count;
+
+		count = 0;
+		start = Profiler::GetTimeNs();
+		phys->TestTree(countPair);
+		treeNs += Profiler::GetTimeNs() - start;
+		treeCount = count;
+
+		// Each cast is new (nothing cached from the last frame)
+		phys->ClearQueryCache();
+		castHits = 0;
+		start = Profiler::GetTimeNs();
+		for (int i = 0; i < NumSegments; i++)
+		{
+			if (phys->SegmentCast(segments[i], castInfo[i]))
+			{
+				castHits++;
+			}
+			else
+			{
+				castInfo[i].mBox = nullptr;
+			}
+		}
+		castNs += Profiler::GetTimeNs() - start;
+
+		start = Profiler::GetTimeNs();
+		phys->SegmentCastBatch(segments, batchInfo);
+		batchNs += Profiler::GetTimeNs() - start;
+		batchHits = 0;
+		numDifferent = 0;
+		for (int i = 0; i < NumSegments; i++)
+		{
+			batchHits += batchInfo[i].mBox ? 1 : 0;
+			numDifferent += batchInfo[i].mBox != castInfo[i].mBox ? 1 : 0;
+		}
+	}
+
+	if (!mMovers.empty())
+	{
+		AddResult(type, numBoxes, "Update", updateNs, NumFrames, mMovers.size(), 0,
+			phys->GetTreeMemoryUsage() + phys->GetSAPMemoryUsage());
+	}
+	if (numBoxes <= MaxPairwiseBoxes)
+	{
+		AddResult(type, numBoxes, "TestPairwise", pairwiseNs, NumFrames, numBoxes,
+			pairwiseCount, 0);
+	}
+	AddResult(type, numBoxes, "TestSweepAndPrune", sapNs, NumFrames, numBoxes,
+		sapCount, phys->GetSAPMemoryUsage());
+	AddResult(type, numBoxes, "TestTree", treeNs, NumFrames, numBoxes,
+		treeCount, phys->GetTreeMemoryUsage());
+	AddResult(type, numBoxes, "SegmentCast", castNs, NumFrames, NumSegments,
+		castHits, phys->GetTreeMemoryUsage());
+	AddResult(type, numBoxes, "SegmentCastBatch", batchNs, NumFrames, NumSegments,
+		batchHits, phys->GetSoAMemoryUsage());
+	mResults.back().mDifferent = numDifferent;
+
+	SDL_Log("Benchmarked %s scene with %d boxes: %zu pairs, %zu of %d casts different",
+		SceneNames[type], numBoxes, sapCount, numDifferent, NumSegments);
+	ClearScene();
+}
+
+void PhysBenchmark::CreateScene(SceneType type, int numBoxes)
+{
+	// Same density at every size
+	mWorldSize = std::cbrt(static_cast<float>(numBoxes)) * BoxSpacing;
+	Vector3 worldMax(mWorldSize, mWorldSize, mWorldSize);
+
+	std::vector<Vector3> clusters;
+	if (type == EClustered)
+	{
+		int numClusters = numBoxes / BoxesPerCluster;
+		numClusters = numClusters > 0 ? numClusters : 1;
+		for (int i = 0; i < numClusters; i++)
+		{
+			clusters.emplace_back(Random::GetVector(Vector3::Zero, worldMax));
+		}
+	}
+
+	mActors.reserve(numBoxes);
+	for (int i = 0; i < numBoxes; i++)
+	{
+		Vector3 pos;
+		if (type == EClustered)
+		{
+			const Vector3& center = clusters[i % clusters.size()];
+			Vector3 radius(ClusterRadius, ClusterRadius, ClusterRadius);
+			pos = Random::GetVector(center - radius, center + radius);
+		}
+		else
+		{
+			pos = Random::GetVector(Vector3::Zero, worldMax);
+		}
+		Vector3 halfSize = Random::GetVector(
+			Vector3(MinHalfSize, MinHalfSize, MinHalfSize),
+			Vector3(MaxHalfSize, MaxHalfSize, MaxHalfSize));
+
+		Actor* actor = new Actor(mGame);
+		actor->SetPosition(pos);
+		BoxComponent* box = new BoxComponent(actor);
+		box->SetObjectBox(AABB(halfSize * -1.0f, halfSize));
+		mActors.emplace_back(actor);
+
+		bool moves = type == EMoving ||
+			(type == EMostlyStatic && Random::GetFloat() < MovingFraction);
+		if (moves)
+		{
+			mMovers.emplace_back(mActors.size() - 1);
+			mVelocities.emplace_back(Random::GetVector(
+				Vector3(-MaxSpeed, -MaxSpeed, -MaxSpeed),
+				Vector3(MaxSpeed, MaxSpeed, MaxSpeed)));
+		}
+	}
+}
+
+void PhysBenchmark::RunStacks(int numBoxes)
+{
+	PhysWorld* phys = mGame->GetPhysWorld();
+	Random::Seed(SceneSeed);
+	CreateStacks(numBoxes);
+	FlushTransforms();
+
+	// Same as a game tick: step, then refit the boxes that moved
+	float deltaTime = mGame->GetTickDelta();
+	uint64_t stepNs = 0;
+	size_t maxContacts = 0;
+	for (int frame = 0; frame < NumSettleFrames; frame++)
+	{
+		uint64_t start = Profiler::GetTimeNs();
+		phys->StepBodies(deltaTime);
+		FlushTransforms();
+		stepNs += Profiler::GetTimeNs() - start;
+		maxContacts = std::max(maxContacts, phys->GetNumContacts());
+	}
+
+	// (count is the bodies still awake at the end, which should be none)
+	size_t numAwake = phys->GetNumAwakeBodies();
+	AddResult(EStacks, numBoxes, "StepBodies", stepNs, NumSettleFrames, numBoxes,
+		numAwake, 0);
+
+	SDL_Log("Benchmarked %s scene with %d bodies: %zu contacts, %zu still awake",
+		SceneNames[EStacks], numBoxes, maxContacts, numAwake);
+	ClearScene();
+}
+
+void PhysBenchmark::CreateStacks(int numBoxes)
+{
+	// Stacks on a square grid, on one static floor box
+	int numStacks = (numBoxes + StackHeight - 1) / StackHeight;
+	int perRow = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(numStacks))));
+	float spacing = StackHalfSize * 2.0f + StackGap;
+	mWorldSize = perRow * spacing;
+
+	Actor* floor = new Actor(mGame);
+	floor->SetPosition(Vector3(mWorldSize * 0.5f, mWorldSize * 0.5f, -StackHalfSize));
+	BoxComponent* floorBox = new BoxComponent(floor);
+	Vector3 floorHalf(mWorldSize * 0.5f, mWorldSize * 0.5f, StackHalfSize);
+	floorBox->SetObjectBox(AABB(floorHalf * -1.0f, floorHalf));
+	mActors.emplace_back(floor);
+
+	Vector3 halfSize(StackHalfSize, StackHalfSize, StackHalfSize);
+	Vector3 jitter(StackJitter, StackJitter, 0.0f);
+	mActors.reserve(numBoxes + 1);
+	for (int i = 0; i < numBoxes; i++)
+	{
+		int stack = i / StackHeight;
+		int level = i % StackHeight;
+		// Resting exactly on the box (or floor) below
+		Vector3 pos((stack % perRow + 0.5f) * spacing,
+			(stack / perRow + 0.5f) * spacing,
+			StackHalfSize * (2 * level + 1));
+		pos += Random::GetVector(jitter * -1.0f, jitter);
+
+		Actor* actor = new Actor(mGame);
+		actor->SetPosition(pos);
+		new RigidBodyComponent(actor);
+		BoxComponent* box = new BoxComponent(actor);
+		box->SetObjectBox(AABB(halfSize * -1.0f, halfSize));
+		mActors.emplace_back(actor);
+	}
+}
+
+void PhysBenchmark::ClearScene()
+{
+	for (auto actor : mGame->GetActors())
+	{
+		actor->SetState(Actor::EDead);
+	}
+	// Deletes them all in one batch
+	mGame->FlushActorChanges();
+
+	mActors.clear();
+	mMovers.clear();
+	mVelocities.clear();
+}
+
+void PhysBenchmark::MoveBoxes()
+{
+	float deltaTime = mGame->GetTickDelta();
+	for (size_t i = 0; i < mMovers.size(); i++)
+	{
+		Actor* actor = mActors[mMovers[i]];
+		Vector3& vel = mVelocities[i];
+		Vector3 pos = actor->GetPosition() + vel * deltaTime;
+		if (pos.x < 0.0f || pos.x > mWorldSize)
+		{
+			vel.x *= -1.0f;
+		}
+		if (pos.y < 0.0f || pos.y > mWorldSize)
+		{
+			vel.y *= -1.0f;
+		}
+		if (pos.z < 0.0f || pos.z > mWorldSize)
+		{
+			vel.z *= -1.0f;
+		}
+		actor->SetPosition(pos);
+	}
+}
+
+void PhysBenchmark::FlushTransforms()
+{
+	mGame->GetTransformSystem()->Update();
+	mGame->GetCommandBuffer()->Execute();
+}
+
+void PhysBenchmark::AddResult(SceneType type, int numBoxes, const char* test,
+	uint64_t totalNs, int runs, size_t items, size_t count, size_t bytes)
+{
+	Result result;
+	result.mScene = SceneNames[type];
+	result.mNumBoxes = numBoxes;
+	result.mTest = test;
+	result.mMs = totalNs / 1.0e6 / runs;
+	result.mThroughput = result.mMs > 0.0 ? items * 1000.0 / result.mMs : 0.0;
+	result.mCount = count;
+	result.mBytes = bytes;
+	result.mDifferent = 0;
+	mResults.emplace_back(result);
+}
+
+bool PhysBenchmark::WriteCSV(const std::string& fileName) const
+{
+	std::ofstream outFile(fileName);
+	if (!outFile.is_open())
+	{
+		SDL_Log("Failed to write benchmark results %s", fileName.c_str());
+		return false;
+	}
+
+	outFile << "scene,boxes,test,ms,throughput,count,bytes,different\n";
+	for (const Result& r : mResults)
+	{
+		outFile << r.mScene << ',' << r.mNumBoxes << ',' << r.mTest << ',' <<
+			r.mMs << ',' << r.mThroughput << ',' << r.mCount << ',' << r.mBytes <<
+			',' << r.mDifferent << '\n';
+	}
+	SDL_Log("Wrote benchmark results %s", fileName.c_str());
+	return true;
+}
+
+bool PhysBenchmark::WriteJSON(const std::string& fileName) const
+{
+	rapidjson::StringBuffer buffer;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+	writer.StartArray();
+	for (const Result& r : mResults)
+	{
+		writer.StartObject();
+		writer.Key("scene"); writer.String(r.mScene);
+		writer.Key("boxes"); writer.Int(r.mNumBoxes);
+		writer.Key("test"); writer.String(r.mTest);
+		writer.Key("ms"); writer.Double(r.mMs);
+		writer.Key("throughput"); writer.Double(r.mThroughput);
+		writer.Key("count"); writer.Uint64(r.mCount);
+		writer.Key("bytes"); writer.Uint64(r.mBytes);
+		writer.Key("different"); writer.Uint64(r.mDifferent);
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	std::ofstream outFile(fileName);
+	if (!outFile.is_open())
+	{
+		SDL_Log("Failed to write benchmark results %s", fileName.c_str());
+		return false;
+	}
+	outFile << buffer.GetString();
+	SDL_Log("Wrote benchmark results %s", fileName.c_str());
+	return true;
+}
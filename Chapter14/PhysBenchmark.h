@@ -0,0 +1,82 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Math.h"
+
+// Builds synthetic scenes of box components (replacing the level) and
+// times the physics world's pair tests and segment casts in each one
+// (checking the batched casts hit the same boxes as the scalar ones),
+// plus stepping stacks of rigid bodies until they fall asleep.
+// Every scene is generated from a fixed seed, so runs are comparable.
+class PhysBenchmark
+{
+public:
+	PhysBenchmark(class Game* game);
+
+	// Run every scene at every size, and write the results to fileName
+	// (JSON if it ends in .json, CSV otherwise)
+	bool Run(const std::string& fileName);
+private:
+	enum SceneType
+	{
+		EUniform,
+		EClustered,
+		EMoving,
+		EMostlyStatic,
+		// Rigid bodies in many small stacks on a floor
+		EStacks,
+
+		NUM_SCENE_TYPES
+	};
+
+	struct Result
+	{
+		const char* mScene;
+		int mNumBoxes;
+		const char* mTest;
+		// Average time for one run of the test
+		double mMs;
+		// Boxes (or casts) per second
+		double mThroughput;
+		// Pairs found (or casts that hit)
+		size_t mCount;
+		// Memory used by the structure the test reads
+		size_t mBytes;
+		// Batched casts whose hit isn't the same box as SegmentCast's
+		size_t mDifferent;
+	};
+
+	void RunScene(SceneType type, int numBoxes);
+	void CreateScene(SceneType type, int numBoxes);
+	// Step the stacks scene until it settles
+	void RunStacks(int numBoxes);
+	void CreateStacks(int numBoxes);
+	// Delete every actor (the level's too, the first time)
+	void ClearScene();
+	// Move the moving boxes one tick, bouncing off the world's sides
+	void MoveBoxes();
+	// Update the transforms, and refit the changed boxes
+	void FlushTransforms();
+	void AddResult(SceneType type, int numBoxes, const char* test,
+		uint64_t totalNs, int runs, size_t items, size_t count, size_t bytes);
+	bool WriteCSV(const std::string& fileName) const;
+	bool WriteJSON(const std::string& fileName) const;
+
+	class Game* mGame;
+	std::vector<class Actor*> mActors;
+	// Indices into mActors of the boxes that move, and their velocities
+	std::vector<size_t> mMovers;
+	std::vector<Vector3> mVelocities;
+	// The scene fills a cube from the origin to here on each axis
+	float mWorldSize;
+	std::vector<Result> mResults;
+};
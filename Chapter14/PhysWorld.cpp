@@ -9,52 +9,431 @@
 #include "PhysWorld.h"
 #include <algorithm>
 #include "BoxComponent.h"
+#include "RigidBodyComponent.h"
+#include "Actor.h"
+#include "Game.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include <SDL/SDL.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PHYS_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// How far (on each side) a box can move before it's reinserted
+	const float TreeMargin = 25.0f;
+	// Padding boxes sit out here, where no segment reaches
+	const float FarAway = 1.0e30f;
+	// Past this many cached casts, start the cache over
+	const size_t MaxCachedCasts = 1024;
+
+	// Solver tuning
+	const int VelocityIterations = 8;
+	// Fraction of the penetration to correct each step
+	const float Baumgarte = 0.2f;
+	// Penetration allowed (so contacts stay touching between steps)
+	const float PenetrationSlop = 0.5f;
+	// Slower than this, and contacts don't bounce
+	const float RestitutionThreshold = 50.0f;
+	// Bodies slower than this for TimeToSleep can sleep
+	const float SleepSpeedSq = 4.0f * 4.0f;
+	const float TimeToSleep = 0.5f;
+	// Islands are mostly small, so each job takes a few
+	const size_t IslandGrainSize = 8;
+
+	// Two directions perpendicular to the normal (and each other)
+	void ComputeTangents(const Vector3& n, Vector3& outT1, Vector3& outT2)
+	{
+		if (Math::Abs(n.x) >= 0.57735f)
+		{
+			outT1 = Vector3(n.y, -n.x, 0.0f);
+		}
+		else
+		{
+			outT1 = Vector3(0.0f, n.z, -n.y);
+		}
+		outT1.Normalize();
+		outT2 = Vector3::Cross(n, outT1);
+	}
+
+	uint64_t PairKey(int a, int b)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) |
+			static_cast<uint32_t>(b);
+	}
+
+	int FindRoot(std::vector<int>& parent, int i)
+	{
+		while (parent[i] != i)
+		{
+			// Path halving
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	}
+
+	// Boxes whose AABBs overlap. Rotated boxes only fill part of their
+	// AABB, so those also need their OBBs to overlap.
+	bool TightOverlap(const BoxComponent* a, const BoxComponent* b)
+	{
+		if (!a->GetIsRotated() && !b->GetIsRotated())
+		{
+			return true;
+		}
+		return Intersect(a->GetWorldOBB(), b->GetWorldOBB());
+	}
+
+	OBB ToOBB(const AABB& box)
+	{
+		return OBB((box.mMin + box.mMax) * 0.5f, Quaternion::Identity,
+			(box.mMax - box.mMin) * 0.5f);
+	}
+
+	// A segment that reaches a rotated box's AABB may still miss the OBB
+	// (or hit it later), so those get the real test, which also gives t
+	bool RefineHit(const LineSegment& l, const BoxComponent* box, float& inOutT)
+	{
+		if (!box->GetIsRotated())
+		{
+			return true;
+		}
+		Vector3 norm;
+		return Intersect(l, box->GetWorldOBB(), inOutT, norm);
+	}
+
+	// Casts whose ends are this close are treated as the same cast
+	const float CastQuantum = 0.25f;
+
+	// 1/d, with a tiny d instead of 0 so the slabs don't give NaNs
+	float SafeInverse(float d)
+	{
+		if (Math::Abs(d) < 1.0e-20f)
+		{
+			d = 1.0e-20f;
+		}
+		return 1.0f / d;
+	}
+
+	// Normal of the box face closest to a point on its surface
+	Vector3 FaceNormal(const AABB& b, const Vector3& point)
+	{
+		const float dists[6] = {
+			Math::Abs(point.x - b.mMin.x), Math::Abs(point.x - b.mMax.x),
+			Math::Abs(point.y - b.mMin.y), Math::Abs(point.y - b.mMax.y),
+			Math::Abs(point.z - b.mMin.z), Math::Abs(point.z - b.mMax.z)
+		};
+		const Vector3 normals[6] = {
+			Vector3::NegUnitX, Vector3::UnitX,
+			Vector3::NegUnitY, Vector3::UnitY,
+			Vector3::NegUnitZ, Vector3::UnitZ
+		};
+		int best = 0;
+		for (int i = 1; i < 6; i++)
+		{
+			if (dists[i] < dists[best])
+			{
+				best = i;
+			}
+		}
+		return normals[best];
+	}
+}
 
 PhysWorld::PhysWorld(Game* game)
 	:mGame(game)
+	,mTree(TreeMargin)
+	,mSoADirty(true)
+	,mGravity(0.0f, 0.0f, -980.0f)
 {
 }
 
-bool PhysWorld::SegmentCast(const LineSegment& l, CollisionInfo& outColl)
+bool PhysWorld::SegmentCast(const LineSegment& l, CollisionInfo& outColl,
+	uint32_t layers)
 {
+	CastKey key = MakeCastKey(l, layers);
+	auto iter = mCastCache.find(key);
+	if (iter != mCastCache.end())
+	{
+		if (iter->second.mHit)
+		{
+			outColl = iter->second.mInfo;
+		}
+		return iter->second.mHit;
+	}
+
 	bool collided = false;
 	// Initialize closestT to infinity, so first
 	// intersection will always update closestT
 	float closestT = Math::Infinity;
 	Vector3 norm;
-	// Test against all boxes
-	for (auto box : mBoxes)
-	{
+	// Test against the boxes in the tree that the segment reaches
+	mTree.RayCast(l, [this, &l, &outColl, &collided, &closestT, &norm, layers](int proxy, float maxT) {
+		BoxComponent* box = static_cast<BoxComponent*>(mTree.GetUserData(proxy));
+		if (!(box->GetLayer() & layers))
+		{
+			return maxT;
+		}
 		float t;
 		// Does the segment intersect with the box?
-		if (Intersect(l, box->GetWorldBox(), t, norm))
+		bool hit = box->GetIsRotated() ? Intersect(l, box->GetWorldOBB(), t, norm) :
+			Intersect(l, box->GetWorldBox(), t, norm);
+		if (hit)
 		{
 			// Is this closer than previous intersection?
 			if (t < closestT)
 			{
+				closestT = t;
 				outColl.mPoint = l.PointOnSegment(t);
 				outColl.mNormal = norm;
 				outColl.mBox = box;
 				outColl.mActor = box->GetOwner();
 				collided = true;
+				// Only look for closer hits from now on
+				return t;
+			}
+		}
+		return maxT;
+	});
+
+	if (mCastCache.size() >= MaxCachedCasts)
+	{
+		mCastCache.clear();
+	}
+	CachedCast& cached = mCastCache[key];
+	cached.mHit = collided;
+	if (collided)
+	{
+		cached.mInfo = outColl;
+	}
+	return collided;
+}
+
+void PhysWorld::ClearQueryCache()
+{
+	mCastCache.clear();
+}
+
+void PhysWorld::InvalidateQueryCache()
+{
+	// (clearing an empty map still touches all its buckets)
+	if (!mCastCache.empty())
+	{
+		mCastCache.clear();
+	}
+}
+
+PhysWorld::CastKey PhysWorld::MakeCastKey(const LineSegment& l, uint32_t layers)
+{
+	const float coords[6] = { l.mStart.x, l.mStart.y, l.mStart.z,
+		l.mEnd.x, l.mEnd.y, l.mEnd.z };
+	CastKey key;
+	for (int i = 0; i < 6; i++)
+	{
+		key.mCoords[i] = static_cast<int32_t>(std::floor(coords[i] / CastQuantum + 0.5f));
+	}
+	key.mLayers = layers;
+	return key;
+}
+
+bool PhysWorld::CastKey::operator==(const CastKey& other) const
+{
+	return memcmp(mCoords, other.mCoords, sizeof(mCoords)) == 0 &&
+		mLayers == other.mLayers;
+}
+
+size_t PhysWorld::CastKeyHash::operator()(const CastKey& key) const
+{
+	// FNV-1a over the coordinates and layers
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < 6; i++)
+	{
+		hash = (hash ^ static_cast<uint32_t>(key.mCoords[i])) * 16777619u;
+	}
+	hash = (hash ^ key.mLayers) * 16777619u;
+	return hash;
+}
+
+void PhysWorld::SegmentCastBatch(const std::vector<LineSegment>& segments,
+	std::vector<CollisionInfo>& outColl)
+{
+	UpdateBoxSoA();
+	outColl.resize(segments.size());
+	size_t numBoxes = mSoABoxes.size();
+
+	for (size_t s = 0; s < segments.size(); s++)
+	{
+		const LineSegment& l = segments[s];
+		Vector3 dir = l.mEnd - l.mStart;
+		float start[3] = { l.mStart.x, l.mStart.y, l.mStart.z };
+		float inv[3] = { SafeInverse(dir.x), SafeInverse(dir.y), SafeInverse(dir.z) };
+
+		// Slab test: t where the segment enters/exits each axis' slab.
+		// The first crossing is the entry, or the exit if it starts inside.
+		// Hits past the end (t > 1) are never closer than closestT.
+		float closestT = 1.0f;
+		int closest = -1;
+#ifdef PHYS_USE_SSE
+		__m128 zero = _mm_setzero_ps();
+		__m128 closestV = _mm_set1_ps(closestT);
+		__m128 startV[3], invV[3];
+		for (int a = 0; a < 3; a++)
+		{
+			startV[a] = _mm_set1_ps(start[a]);
+			invV[a] = _mm_set1_ps(inv[a]);
+		}
+		for (size_t i = 0; i < numBoxes; i += 4)
+		{
+			__m128 tEnter = _mm_set1_ps(-FLT_MAX);
+			__m128 tExit = _mm_set1_ps(FLT_MAX);
+			for (int a = 0; a < 3; a++)
+			{
+				__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&mSoAMin[a][i]), startV[a]), invV[a]);
+				__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&mSoAMax[a][i]), startV[a]), invV[a]);
+				tEnter = _mm_max_ps(tEnter, _mm_min_ps(t1, t2));
+				tExit = _mm_min_ps(tExit, _mm_max_ps(t1, t2));
+			}
+			__m128 outside = _mm_cmpge_ps(tEnter, zero);
+			__m128 t = _mm_or_ps(_mm_and_ps(outside, tEnter), _mm_andnot_ps(outside, tExit));
+			// Anything in the box is at least this far along (it's only
+			// a candidate until the lane's own t is checked below)
+			__m128 lower = _mm_max_ps(tEnter, zero);
+			__m128 hit = _mm_and_ps(_mm_cmple_ps(tEnter, tExit),
+				_mm_and_ps(_mm_cmpge_ps(tExit, zero), _mm_cmple_ps(lower, closestV)));
+			int mask = _mm_movemask_ps(hit);
+			if (mask != 0)
+			{
+				float ts[4];
+				_mm_storeu_ps(ts, t);
+				for (int j = 0; j < 4; j++)
+				{
+					float tj = ts[j];
+					if ((mask & (1 << j)) && RefineHit(l, mSoABoxes[i + j], tj) &&
+						tj <= closestT && (closest == -1 || tj < closestT))
+					{
+						closestT = tj;
+						closest = static_cast<int>(i) + j;
+					}
+				}
+				closestV = _mm_set1_ps(closestT);
 			}
 		}
+#else
+		for (size_t i = 0; i < numBoxes; i++)
+		{
+			float tEnter = -FLT_MAX;
+			float tExit = FLT_MAX;
+			for (int a = 0; a < 3; a++)
+			{
+				float t1 = (mSoAMin[a][i] - start[a]) * inv[a];
+				float t2 = (mSoAMax[a][i] - start[a]) * inv[a];
+				tEnter = Math::Max(tEnter, Math::Min(t1, t2));
+				tExit = Math::Min(tExit, Math::Max(t1, t2));
+			}
+			float t = tEnter >= 0.0f ? tEnter : tExit;
+			if (tEnter <= tExit && tExit >= 0.0f && Math::Max(tEnter, 0.0f) <= closestT &&
+				RefineHit(l, mSoABoxes[i], t) && t <= closestT &&
+				(closest == -1 || t < closestT))
+			{
+				closestT = t;
+				closest = static_cast<int>(i);
+			}
+		}
+#endif
+
+		CollisionInfo& info = outColl[s];
+		if (closest >= 0)
+		{
+			BoxComponent* box = mSoABoxes[closest];
+			info.mPoint = l.PointOnSegment(closestT);
+			if (box->GetIsRotated())
+			{
+				Intersect(l, box->GetWorldOBB(), closestT, info.mNormal);
+			}
+			else
+			{
+				info.mNormal = FaceNormal(box->GetWorldBox(), info.mPoint);
+			}
+			info.mBox = box;
+			info.mActor = box->GetOwner();
+		}
+		else
+		{
+			info.mBox = nullptr;
+			info.mActor = nullptr;
+		}
 	}
+}
+
+bool PhysWorld::SweepSphere(const Sphere& sphere, const Vector3& end,
+	CollisionInfo& outColl, float& outT, uint32_t layers)
+{
+	// Only the boxes near the whole sweep can be hit
+	Vector3 radius(sphere.mRadius, sphere.mRadius, sphere.mRadius);
+	AABB bounds(sphere.mCenter, sphere.mCenter);
+	bounds.UpdateMinMax(end);
+	bounds.mMin -= radius;
+	bounds.mMax += radius;
+
+	bool collided = false;
+	mTree.Query(bounds, [this, &sphere, &end, &outColl, &outT, &collided, layers](int proxy) {
+		BoxComponent* box = static_cast<BoxComponent*>(mTree.GetUserData(proxy));
+		if (!(box->GetLayer() & layers))
+		{
+			return true;
+		}
+		float t;
+		Vector3 norm;
+		bool hit = box->GetIsRotated() ?
+			SweptSphere(sphere, end, box->GetWorldOBB(), t, norm) :
+			SweptSphere(sphere, end, box->GetWorldBox(), t, norm);
+		if (hit && (!collided || t < outT))
+		{
+			outT = t;
+			Vector3 center = Vector3::Lerp(sphere.mCenter, end, t);
+			outColl.mPoint = center - norm * sphere.mRadius;
+			outColl.mNormal = norm;
+			outColl.mBox = box;
+			outColl.mActor = box->GetOwner();
+			collided = true;
+		}
+		return true;
+	});
 	return collided;
 }
 
+void PhysWorld::OverlapBox(const AABB& box, std::vector<BoxComponent*>& outBoxes,
+	uint32_t layers)
+{
+	mTree.Query(box, [this, &box, &outBoxes, layers](int proxy) {
+		// The tree has fat boxes, so check the real one
+		BoxComponent* other = static_cast<BoxComponent*>(mTree.GetUserData(proxy));
+		if ((other->GetLayer() & layers) && Intersect(box, other->GetWorldBox()) &&
+			(!other->GetIsRotated() || Intersect(ToOBB(box), other->GetWorldOBB())))
+		{
+			outBoxes.emplace_back(other);
+		}
+		return true;
+	});
+}
+
 void PhysWorld::TestPairwise(std::function<void(Actor*, Actor*)> f)
 {
 	// Naive implementation O(n^2)
-	for (size_t i = 0; i < mBoxes.size(); i++)
+	for (size_t i = 0; i < mBoxes.Size(); i++)
 	{
 		// Don't need to test vs itself and any previous i values
-		for (size_t j = i + 1; j < mBoxes.size(); j++)
+		for (size_t j = i + 1; j < mBoxes.Size(); j++)
 		{
 			BoxComponent* a = mBoxes[i];
 			BoxComponent* b = mBoxes[j];
-			if (Intersect(a->GetWorldBox(), b->GetWorldBox()))
+			if (Intersect(a->GetWorldBox(), b->GetWorldBox()) && TightOverlap(a, b))
 			{
 				// Call supplied function to handle intersection
 				f(a->GetOwner(), b->GetOwner());
@@ -65,48 +444,663 @@ void PhysWorld::TestPairwise(std::function<void(Actor*, Actor*)> f)
 
 void PhysWorld::TestSweepAndPrune(std::function<void(Actor*, Actor*)> f)
 {
-	// Sort by min.x
-	std::sort(mBoxes.begin(), mBoxes.end(),
-		[](BoxComponent* a, BoxComponent* b) {
-			return a->GetWorldBox().mMin.x <
-				b->GetWorldBox().mMin.x;
+	// The pairs were already found as the boxes moved
+	// (they overlap on all three axes, so only rotated boxes need testing)
+	mSAP.ForEachPair([&f](void* userA, void* userB) {
+		BoxComponent* a = static_cast<BoxComponent*>(userA);
+		BoxComponent* b = static_cast<BoxComponent*>(userB);
+		if (TightOverlap(a, b))
+		{
+			f(a->GetOwner(), b->GetOwner());
+		}
 	});
+}
 
-	for (size_t i = 0; i < mBoxes.size(); i++)
+void PhysWorld::ProcessContacts(std::function<void(ContactEvent, BoxComponent*,
+	BoxComponent*)> f)
+{
+	mSAP.ReportPairs([&f](SweepAndPrune::PairEvent e, void* userA, void* userB) {
+		ContactEvent contact = EContactPersist;
+		if (e == SweepAndPrune::EBegin)
+		{
+			contact = EContactBegin;
+		}
+		else if (e == SweepAndPrune::EEnd)
+		{
+			contact = EContactEnd;
+		}
+		f(contact, static_cast<BoxComponent*>(userA),
+			static_cast<BoxComponent*>(userB));
+	});
+}
+
+void PhysWorld::TestTree(std::function<void(Actor*, Actor*)> f)
+{
+	mTree.QueryPairs([this, &f](int proxyA, int proxyB) {
+		BoxComponent* a = static_cast<BoxComponent*>(mTree.GetUserData(proxyA));
+		BoxComponent* b = static_cast<BoxComponent*>(mTree.GetUserData(proxyB));
+		if (Intersect(a->GetWorldBox(), b->GetWorldBox()) && TightOverlap(a, b))
+		{
+			f(a->GetOwner(), b->GetOwner());
+		}
+	});
+}
+
+SlotHandle PhysWorld::AddBox(BoxComponent* box)
+{
+	box->SetProxyID(mTree.CreateProxy(box->GetWorldBox(), box));
+	mSoADirty = true;
+	InvalidateQueryCache();
+	return mBoxes.Insert(box);
+}
+
+void PhysWorld::RemoveBox(SlotHandle handle)
+{
+	BoxComponent** box = mBoxes.Get(handle);
+	if (box)
 	{
-		// Get max.x for current box
-		BoxComponent* a = mBoxes[i];
-		float max = a->GetWorldBox().mMax.x;
-		for (size_t j = i + 1; j < mBoxes.size(); j++)
+		// Wake any bodies resting on it, since they may now fall
+		// (the tree's boxes are fattened, so touching ones are found)
+		BoxComponent* removed = *box;
+		mTree.Query(removed->GetWorldBox(), [this, removed](int proxy) {
+			BoxComponent* other = static_cast<BoxComponent*>(mTree.GetUserData(proxy));
+			RigidBodyComponent* otherBody = other->GetRigidBody();
+			if (other != removed && otherBody)
+			{
+				WakeBody(otherBody);
+			}
+			return true;
+		});
+		mTree.DestroyProxy((*box)->GetProxyID());
+		if ((*box)->GetSAPProxyID() != SweepAndPrune::NullProxy)
 		{
-			BoxComponent* b = mBoxes[j];
-			// If AABB[j] min is past the max bounds of AABB[i],
-			// then there aren't any other possible intersections
-			// against AABB[i]
-			if (b->GetWorldBox().mMin.x > max)
+			mSAP.DestroyProxy((*box)->GetSAPProxyID());
+		}
+		mBoxes.Remove(handle);
+		mSoADirty = true;
+		InvalidateQueryCache();
+	}
+}
+
+void PhysWorld::UpdateBox(SlotHandle handle)
+{
+	// (the box may have been removed since the update was queued)
+	BoxComponent** box = mBoxes.Get(handle);
+	if (box)
+	{
+		mTree.MoveProxy((*box)->GetProxyID(), (*box)->GetWorldBox());
+		mSoADirty = true;
+		InvalidateQueryCache();
+
+		// Boxes join the sweep and prune on their first update, so the
+		// ones still sitting at the origin don't all overlap each other
+		if ((*box)->GetSAPProxyID() == SweepAndPrune::NullProxy)
+		{
+			(*box)->SetSAPProxyID(mSAP.CreateProxy((*box)->GetWorldBox(), *box));
+		}
+		else
+		{
+			mSAP.UpdateProxy((*box)->GetSAPProxyID(), (*box)->GetWorldBox());
+		}
+	}
+}
+
+void PhysWorld::BeginBatchRemove()
+{
+	mBoxes.BeginBatchRemove();
+	mBodies.BeginBatchRemove();
+}
+
+void PhysWorld::EndBatchRemove()
+{
+	mBoxes.EndBatchRemove();
+	mBodies.EndBatchRemove();
+}
+
+void PhysWorld::UpdateBoxSoA()
+{
+	if (!mSoADirty)
+	{
+		return;
+	}
+	mSoADirty = false;
+
+	size_t numBoxes = mBoxes.Size();
+	size_t padded = (numBoxes + 3) & ~static_cast<size_t>(3);
+	mSoABoxes.resize(padded);
+	for (int a = 0; a < 3; a++)
+	{
+		mSoAMin[a].resize(padded);
+		mSoAMax[a].resize(padded);
+	}
+
+	for (size_t i = 0; i < numBoxes; i++)
+	{
+		BoxComponent* box = mBoxes[i];
+		const AABB& b = box->GetWorldBox();
+		mSoABoxes[i] = box;
+		mSoAMin[0][i] = b.mMin.x;
+		mSoAMin[1][i] = b.mMin.y;
+		mSoAMin[2][i] = b.mMin.z;
+		mSoAMax[0][i] = b.mMax.x;
+		mSoAMax[1][i] = b.mMax.y;
+		mSoAMax[2][i] = b.mMax.z;
+	}
+	// The padding boxes can't be hit
+	for (size_t i = numBoxes; i < padded; i++)
+	{
+		mSoABoxes[i] = nullptr;
+		for (int a = 0; a < 3; a++)
+		{
+			mSoAMin[a][i] = FarAway;
+			mSoAMax[a][i] = FarAway;
+		}
+	}
+}
+
+size_t PhysWorld::GetSoAMemoryUsage() const
+{
+	size_t bytes = mSoABoxes.capacity() * sizeof(BoxComponent*);
+	for (int a = 0; a < 3; a++)
+	{
+		bytes += (mSoAMin[a].capacity() + mSoAMax[a].capacity()) * sizeof(float);
+	}
+	return bytes;
+}
+
+SlotHandle PhysWorld::AddBody(RigidBodyComponent* body)
+{
+	// New bodies start awake
+	body->SetAwakeIndex(static_cast<int>(mAwakeBodies.size()));
+	mAwakeBodies.emplace_back(body);
+	return mBodies.Insert(body);
+}
+
+void PhysWorld::RemoveBody(SlotHandle handle)
+{
+	RigidBodyComponent** found = mBodies.Get(handle);
+	if (!found)
+	{
+		return;
+	}
+
+	// Wake its island first, since whatever rested on it may now fall
+	RigidBodyComponent* body = *found;
+	WakeBody(body);
+	RemoveAwake(body);
+	mBodies.Remove(handle);
+}
+
+void PhysWorld::WakeBody(RigidBodyComponent* body)
+{
+	if (body->GetIsAwake())
+	{
+		return;
+	}
+
+	// Wake the whole island it fell asleep with
+	RigidBodyComponent* iter = body;
+	do
+	{
+		RigidBodyComponent* next = iter->GetNextAsleep();
+		iter->SetNextAsleep(nullptr);
+		iter->SetSleepTime(0.0f);
+		iter->SetAwakeIndex(static_cast<int>(mAwakeBodies.size()));
+		mAwakeBodies.emplace_back(iter);
+		iter = next;
+	} while (iter && iter != body);
+}
+
+void PhysWorld::RemoveAwake(RigidBodyComponent* body)
+{
+	// Swap with the last awake body
+	int index = body->GetAwakeIndex();
+	RigidBodyComponent* last = mAwakeBodies.back();
+	mAwakeBodies[index] = last;
+	last->SetAwakeIndex(index);
+	mAwakeBodies.pop_back();
+	body->SetAwakeIndex(-1);
+}
+
+void PhysWorld::StepBodies(float deltaTime)
+{
+	PROFILE_SCOPE("PhysWorld::StepBodies");
+	if (mAwakeBodies.empty())
+	{
+		mContacts.clear();
+		return;
+	}
+
+	for (auto body : mAwakeBodies)
+	{
+		// (a body without mass is static, so gravity doesn't pull it)
+		if (body->GetInvMass() > 0.0f)
+		{
+			body->SetVelocity(body->GetVelocity() + mGravity * deltaTime);
+		}
+	}
+
+	FindContacts();
+	BuildIslands();
+
+	// Islands share no bodies or contacts, so they're solved in parallel.
+	// Each island is solved the same way whichever thread runs it, so
+	// the results don't depend on the number of threads.
+	mIslandCanSleep.resize(mIslands.size());
+	mGame->GetJobSystem()->ParallelFor(mIslands.size(), IslandGrainSize,
+		[this, deltaTime](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
 			{
-				break;
+				SolveIsland(mIslands[i], deltaTime);
+				mIslandCanSleep[i] = UpdateSleep(mIslands[i], deltaTime) ? 1 : 0;
 			}
-			else if (Intersect(a->GetWorldBox(), b->GetWorldBox()))
+	});
+
+	// Save the impulses for warm starting next step
+	mNextImpulseCache.clear();
+	for (const Contact& c : mContacts)
+	{
+		CachedImpulses& cached = mNextImpulseCache[c.mKey];
+		cached.mNumPoints = c.mManifold.mNumPoints;
+		for (int i = 0; i < c.mManifold.mNumPoints; i++)
+		{
+			cached.mNormal[i] = c.mNormalImpulse[i];
+			cached.mTangent1[i] = c.mTangentImpulse1[i];
+			cached.mTangent2[i] = c.mTangentImpulse2[i];
+		}
+	}
+	mImpulseCache.swap(mNextImpulseCache);
+
+	// Link up the islands that settled (while the awake indices the
+	// islands refer to are all still valid)
+	bool anySleep = false;
+	for (size_t i = 0; i < mIslands.size(); i++)
+	{
+		if (mIslandCanSleep[i])
+		{
+			SleepIsland(mIslands[i]);
+			anySleep = true;
+		}
+	}
+
+	// Then take all of them out of the awake list in one pass
+	if (anySleep)
+	{
+		size_t numAwake = 0;
+		for (size_t i = 0; i < mAwakeBodies.size(); i++)
+		{
+			RigidBodyComponent* body = mAwakeBodies[i];
+			if (body->GetNextAsleep())
 			{
-				f(a->GetOwner(), b->GetOwner());
+				body->SetAwakeIndex(-1);
+			}
+			else
+			{
+				body->SetAwakeIndex(static_cast<int>(numAwake));
+				mAwakeBodies[numAwake++] = body;
+			}
+		}
+		mAwakeBodies.resize(numAwake);
+	}
+}
+
+void PhysWorld::FindContacts()
+{
+	mContacts.clear();
+	// (bodies woken along the way are added to the end, and checked too)
+	for (size_t i = 0; i < mAwakeBodies.size(); i++)
+	{
+		RigidBodyComponent* body = mAwakeBodies[i];
+		BoxComponent* box = body->GetBox();
+		if (!box)
+		{
+			continue;
+		}
+
+		mTree.Query(box->GetWorldBox(), [this, i, body, box](int proxy) {
+			BoxComponent* other = static_cast<BoxComponent*>(mTree.GetUserData(proxy));
+			RigidBodyComponent* otherBody = other->GetRigidBody();
+			// Pairs of awake bodies are found by the one that's first
+			if (other == box || (otherBody && otherBody->GetIsAwake() &&
+				otherBody->GetAwakeIndex() < static_cast<int>(i)))
+			{
+				return true;
+			}
+
+			// Keep pairs of bodies in the same order every step
+			Contact c;
+			c.mBodyA = body;
+			c.mBodyB = otherBody;
+			BoxComponent* boxA = box;
+			BoxComponent* boxB = other;
+			if (otherBody && other->GetProxyID() < box->GetProxyID())
+			{
+				std::swap(c.mBodyA, c.mBodyB);
+				std::swap(boxA, boxB);
+			}
+			if (!CollideShapes(boxA, boxB, c.mManifold))
+			{
+				return true;
+			}
+			if (otherBody)
+			{
+				WakeBody(otherBody);
+			}
+
+			c.mKey = PairKey(boxA->GetProxyID(), boxB->GetProxyID());
+			ComputeTangents(c.mManifold.mNormal, c.mTangent1, c.mTangent2);
+			c.mFriction = c.mBodyA->GetFriction();
+			c.mRestitution = c.mBodyA->GetRestitution();
+			if (c.mBodyB)
+			{
+				c.mFriction = Math::Sqrt(c.mFriction * c.mBodyB->GetFriction());
+				c.mRestitution = Math::Max(c.mRestitution, c.mBodyB->GetRestitution());
+			}
+
+			// Warm start from last step's impulses (if it was touching)
+			auto iter = mImpulseCache.find(c.mKey);
+			bool warm = iter != mImpulseCache.end() &&
+				iter->second.mNumPoints == c.mManifold.mNumPoints;
+			for (int p = 0; p < c.mManifold.mNumPoints; p++)
+			{
+				c.mNormalImpulse[p] = warm ? iter->second.mNormal[p] : 0.0f;
+				c.mTangentImpulse1[p] = warm ? iter->second.mTangent1[p] : 0.0f;
+				c.mTangentImpulse2[p] = warm ? iter->second.mTangent2[p] : 0.0f;
+			}
+			mContacts.emplace_back(c);
+			return true;
+		});
+	}
+}
+
+bool PhysWorld::CollideShapes(BoxComponent* a, BoxComponent* b, ContactManifold& m)
+{
+	RigidBodyComponent* bodies[2] = { a->GetRigidBody(), b->GetRigidBody() };
+	RigidBodyComponent::Shape shapes[2];
+	for (int i = 0; i < 2; i++)
+	{
+		shapes[i] = bodies[i] ? bodies[i]->GetShape() : RigidBodyComponent::EBox;
+	}
+
+	// Sphere/capsule first, so swap if needed (and flip the normal after)
+	bool flip = shapes[0] == RigidBodyComponent::EBox && shapes[1] != RigidBodyComponent::EBox;
+	flip = flip || (shapes[0] == RigidBodyComponent::ESphere &&
+		shapes[1] == RigidBodyComponent::ECapsule);
+	if (flip)
+	{
+		std::swap(a, b);
+		std::swap(bodies[0], bodies[1]);
+		std::swap(shapes[0], shapes[1]);
+	}
+
+	bool hit = false;
+	Sphere sphereA(Vector3::Zero, 0.0f);
+	Sphere sphereB(Vector3::Zero, 0.0f);
+	Capsule capsuleA(Vector3::Zero, Vector3::Zero, 0.0f);
+	Capsule capsuleB(Vector3::Zero, Vector3::Zero, 0.0f);
+	// Rotated boxes use their OBB, rather than the looser AABB
+	bool rotatedB = b->GetIsRotated();
+	switch (shapes[0])
+	{
+	case RigidBodyComponent::EBox:
+		if (a->GetIsRotated() || rotatedB)
+		{
+			hit = Collide(a->GetWorldOBB(), b->GetWorldOBB(), m);
+		}
+		else
+		{
+			hit = Collide(a->GetWorldBox(), b->GetWorldBox(), m);
+		}
+		break;
+	case RigidBodyComponent::ESphere:
+		bodies[0]->GetSphere(sphereA);
+		if (shapes[1] == RigidBodyComponent::EBox)
+		{
+			hit = rotatedB ? Collide(sphereA, b->GetWorldOBB(), m) :
+				Collide(sphereA, b->GetWorldBox(), m);
+		}
+		else
+		{
+			bodies[1]->GetSphere(sphereB);
+			hit = Collide(sphereA, sphereB, m);
+		}
+		break;
+	case RigidBodyComponent::ECapsule:
+		bodies[0]->GetCapsule(capsuleA);
+		if (shapes[1] == RigidBodyComponent::EBox)
+		{
+			hit = rotatedB ? Collide(capsuleA, b->GetWorldOBB(), m) :
+				Collide(capsuleA, b->GetWorldBox(), m);
+		}
+		else if (shapes[1] == RigidBodyComponent::ESphere)
+		{
+			bodies[1]->GetSphere(sphereB);
+			hit = Collide(capsuleA, sphereB, m);
+		}
+		else
+		{
+			bodies[1]->GetCapsule(capsuleB);
+			hit = Collide(capsuleA, capsuleB, m);
+		}
+		break;
+	}
+
+	if (hit && flip)
+	{
+		m.mNormal = m.mNormal * -1.0f;
+	}
+	return hit;
+}
+
+void PhysWorld::BuildIslands()
+{
+	// Union the bodies on both sides of each contact
+	// (still boxes don't join islands together)
+	size_t numBodies = mAwakeBodies.size();
+	mIslandParent.resize(numBodies);
+	for (size_t i = 0; i < numBodies; i++)
+	{
+		mIslandParent[i] = static_cast<int>(i);
+	}
+	for (const Contact& c : mContacts)
+	{
+		if (c.mBodyB)
+		{
+			int rootA = FindRoot(mIslandParent, c.mBodyA->GetAwakeIndex());
+			int rootB = FindRoot(mIslandParent, c.mBodyB->GetAwakeIndex());
+			// Lower index is the root, so islands come out in body order
+			if (rootA < rootB)
+			{
+				mIslandParent[rootB] = rootA;
+			}
+			else if (rootB < rootA)
+			{
+				mIslandParent[rootA] = rootB;
 			}
 		}
 	}
+
+	// Number the islands, and count their bodies and contacts
+	mIslands.clear();
+	mIslandIndex.assign(numBodies, -1);
+	for (size_t i = 0; i < numBodies; i++)
+	{
+		int root = FindRoot(mIslandParent, static_cast<int>(i));
+		if (mIslandIndex[root] < 0)
+		{
+			mIslandIndex[root] = static_cast<int>(mIslands.size());
+			mIslands.emplace_back(Island{ 0, 0, 0, 0 });
+		}
+		mIslandIndex[i] = mIslandIndex[root];
+		mIslands[mIslandIndex[i]].mNumBodies++;
+	}
+	for (const Contact& c : mContacts)
+	{
+		mIslands[mIslandIndex[c.mBodyA->GetAwakeIndex()]].mNumContacts++;
+	}
+
+	// Lay them out back to back (keeping body and contact order)
+	size_t bodyStart = 0;
+	size_t contactStart = 0;
+	for (Island& island : mIslands)
+	{
+		island.mBodyStart = bodyStart;
+		island.mContactStart = contactStart;
+		bodyStart += island.mNumBodies;
+		contactStart += island.mNumContacts;
+		island.mNumBodies = 0;
+		island.mNumContacts = 0;
+	}
+	mIslandBodies.resize(numBodies);
+	mIslandContacts.resize(mContacts.size());
+	for (size_t i = 0; i < numBodies; i++)
+	{
+		Island& island = mIslands[mIslandIndex[i]];
+		mIslandBodies[island.mBodyStart + island.mNumBodies++] = static_cast<int>(i);
+	}
+	for (size_t i = 0; i < mContacts.size(); i++)
+	{
+		Island& island = mIslands[mIslandIndex[mContacts[i].mBodyA->GetAwakeIndex()]];
+		mIslandContacts[island.mContactStart + island.mNumContacts++] = static_cast<int>(i);
+	}
+}
+
+void PhysWorld::SolveIsland(const Island& island, float deltaTime)
+{
+	const int* contacts = mIslandContacts.data() + island.mContactStart;
+
+	// Set up the contacts, and apply last step's impulses
+	for (size_t i = 0; i < island.mNumContacts; i++)
+	{
+		Contact& c = mContacts[contacts[i]];
+		RigidBodyComponent* a = c.mBodyA;
+		RigidBodyComponent* b = c.mBodyB;
+		float invMassB = b ? b->GetInvMass() : 0.0f;
+		float invMassSum = a->GetInvMass() + invMassB;
+		c.mMass = invMassSum > 0.0f ? 1.0f / invMassSum : 0.0f;
+
+		const Vector3& n = c.mManifold.mNormal;
+		Vector3 velB = b ? b->GetVelocity() : Vector3::Zero;
+		float approach = Vector3::Dot(velB - a->GetVelocity(), n);
+		Vector3 impulse = Vector3::Zero;
+		for (int p = 0; p < c.mManifold.mNumPoints; p++)
+		{
+			// Push out some of the penetration, and bounce if fast enough
+			float bias = Baumgarte / deltaTime *
+				Math::Max(c.mManifold.mDepths[p] - PenetrationSlop, 0.0f);
+			if (approach < -RestitutionThreshold)
+			{
+				bias = Math::Max(bias, -c.mRestitution * approach);
+			}
+			c.mVelocityBias[p] = bias;
+
+			impulse += n * c.mNormalImpulse[p] + c.mTangent1 * c.mTangentImpulse1[p] +
+				c.mTangent2 * c.mTangentImpulse2[p];
+		}
+		a->SetVelocity(a->GetVelocity() - impulse * a->GetInvMass());
+		if (b)
+		{
+			b->SetVelocity(b->GetVelocity() + impulse * invMassB);
+		}
+	}
+
+	// Sequential impulses
+	for (int iter = 0; iter < VelocityIterations; iter++)
+	{
+		for (size_t i = 0; i < island.mNumContacts; i++)
+		{
+			Contact& c = mContacts[contacts[i]];
+			RigidBodyComponent* a = c.mBodyA;
+			RigidBodyComponent* b = c.mBodyB;
+			float invMassA = a->GetInvMass();
+			float invMassB = b ? b->GetInvMass() : 0.0f;
+			Vector3 velA = a->GetVelocity();
+			Vector3 velB = b ? b->GetVelocity() : Vector3::Zero;
+			const Vector3& n = c.mManifold.mNormal;
+
+			for (int p = 0; p < c.mManifold.mNumPoints; p++)
+			{
+				// Friction, limited by the normal impulse
+				float maxFriction = c.mFriction * c.mNormalImpulse[p];
+				Vector3 dv = velB - velA;
+				float lambda = -Vector3::Dot(dv, c.mTangent1) * c.mMass;
+				float total = Math::Clamp(c.mTangentImpulse1[p] + lambda,
+					-maxFriction, maxFriction);
+				Vector3 impulse = c.mTangent1 * (total - c.mTangentImpulse1[p]);
+				c.mTangentImpulse1[p] = total;
+
+				lambda = -Vector3::Dot(dv, c.mTangent2) * c.mMass;
+				total = Math::Clamp(c.mTangentImpulse2[p] + lambda,
+					-maxFriction, maxFriction);
+				impulse += c.mTangent2 * (total - c.mTangentImpulse2[p]);
+				c.mTangentImpulse2[p] = total;
+				velA -= impulse * invMassA;
+				velB += impulse * invMassB;
+
+				// Normal (can only push apart)
+				dv = velB - velA;
+				lambda = (c.mVelocityBias[p] - Vector3::Dot(dv, n)) * c.mMass;
+				total = Math::Max(c.mNormalImpulse[p] + lambda, 0.0f);
+				impulse = n * (total - c.mNormalImpulse[p]);
+				c.mNormalImpulse[p] = total;
+				velA -= impulse * invMassA;
+				velB += impulse * invMassB;
+			}
+
+			a->SetVelocity(velA);
+			if (b)
+			{
+				b->SetVelocity(velB);
+			}
+		}
+	}
+
+	// Move the bodies
+	for (size_t i = 0; i < island.mNumBodies; i++)
+	{
+		RigidBodyComponent* body = mAwakeBodies[mIslandBodies[island.mBodyStart + i]];
+		if (body->GetInvMass() > 0.0f)
+		{
+			Actor* owner = body->GetOwner();
+			owner->SetPosition(owner->GetPosition() + body->GetVelocity() * deltaTime);
+		}
+	}
 }
 
-void PhysWorld::AddBox(BoxComponent* box)
+bool PhysWorld::UpdateSleep(const Island& island, float deltaTime)
 {
-	mBoxes.emplace_back(box);
+	// The island sleeps when all of it has been slow for long enough
+	float minSleepTime = Math::Infinity;
+	for (size_t i = 0; i < island.mNumBodies; i++)
+	{
+		RigidBodyComponent* body = mAwakeBodies[mIslandBodies[island.mBodyStart + i]];
+		if (body->GetVelocity().LengthSq() > SleepSpeedSq)
+		{
+			body->SetSleepTime(0.0f);
+		}
+		else
+		{
+			body->SetSleepTime(body->GetSleepTime() + deltaTime);
+		}
+		minSleepTime = Math::Min(minSleepTime, body->GetSleepTime());
+	}
+	return minSleepTime >= TimeToSleep;
 }
 
-void PhysWorld::RemoveBox(BoxComponent* box)
+void PhysWorld::SleepIsland(const Island& island)
 {
-	auto iter = std::find(mBoxes.begin(), mBoxes.end(), box);
-	if (iter != mBoxes.end())
+	// Link the bodies in a ring, so waking one wakes them all
+	RigidBodyComponent* first = mAwakeBodies[mIslandBodies[island.mBodyStart]];
+	RigidBodyComponent* prev = nullptr;
+	for (size_t i = 0; i < island.mNumBodies; i++)
 	{
-		// Swap to end of vector and pop off (avoid erase copies)
-		std::iter_swap(iter, mBoxes.end() - 1);
-		mBoxes.pop_back();
+		RigidBodyComponent* body = mAwakeBodies[mIslandBodies[island.mBodyStart + i]];
+		body->SetVelocity(Vector3::Zero);
+		if (prev)
+		{
+			prev->SetNextAsleep(body);
+		}
+		prev = body;
 	}
+	prev->SetNextAsleep(first);
 }
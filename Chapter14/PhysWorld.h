@@ -9,14 +9,27 @@
 #pragma once
 #include <vector>
 #include <functional>
+#include <unordered_map>
 #include "Math.h"
 #include "Collision.h"
+#include "SlotMap.h"
+#include "AABBTree.h"
+#include "SweepAndPrune.h"
 
 class PhysWorld
 {
 public:
 	PhysWorld(class Game* game);
 
+	// Each box is on one layer, and queries only see the layers in
+	// their mask
+	enum CollisionLayer
+	{
+		ELayerDefault = 1 << 0,
+		ELayerTarget = 1 << 1,
+		ELayerAll = 0xFFFFFFFF
+	};
+
 	// Used to give helpful information about collision results
 	struct CollisionInfo
 	{
@@ -31,18 +44,179 @@ public:
 	};
 
 	// Test a line segment against boxes
-	// Returns true if it collides against a box
-	bool SegmentCast(const LineSegment& l, CollisionInfo& outColl);
+	// Returns true if it collides against a box (the closest one)
+	// Results are cached until a box changes, so nearly the same cast
+	// again is just a lookup (even frames later). Main thread only.
+	bool SegmentCast(const LineSegment& l, CollisionInfo& outColl,
+		uint32_t layers = ELayerAll);
+	// Forget cached casts (so the next casts are done from scratch)
+	void ClearQueryCache();
+	// Boxes changed, so the cached casts are wrong
+	void InvalidateQueryCache();
+
+	// Test many segments at once (4 boxes at a time with SIMD)
+	// Each outColl has the closest hit for that segment, or a null mBox
+	// if it didn't hit anything
+	void SegmentCastBatch(const std::vector<LineSegment>& segments,
+		std::vector<CollisionInfo>& outColl);
+
+	// Continuous collision: sweep a sphere from its center to end,
+	// and find the first box it touches. outT is the time of impact
+	// (as a fraction of the way to end), and the collision point is
+	// where the sphere touches the box then.
+	bool SweepSphere(const Sphere& sphere, const Vector3& end,
+		CollisionInfo& outColl, float& outT, uint32_t layers = ELayerAll);
+
+	// Find every box overlapping the given box
+	void OverlapBox(const AABB& box, std::vector<class BoxComponent*>& outBoxes,
+		uint32_t layers = ELayerAll);
 
 	// Tests collisions using naive pairwise
 	void TestPairwise(std::function<void(class Actor*, class Actor*)> f);
 	// Test collisions using sweep and prune
+	// (the overlapping pairs are kept up to date as boxes move)
 	void TestSweepAndPrune(std::function<void(class Actor*, class Actor*)> f);
+	// Report the sweep and prune's overlapping pairs as contacts that
+	// began, persisted or ended since the last call
+	enum ContactEvent
+	{
+		EContactBegin,
+		EContactPersist,
+		EContactEnd
+	};
+	void ProcessContacts(std::function<void(ContactEvent, class BoxComponent*,
+		class BoxComponent*)> f);
+	// Test collisions using the box tree
+	void TestTree(std::function<void(class Actor*, class Actor*)> f);
 
 	// Add/remove box components from world
-	void AddBox(class BoxComponent* box);
-	void RemoveBox(class BoxComponent* box);
+	// (add returns the handle to remove with)
+	SlotHandle AddBox(class BoxComponent* box);
+	void RemoveBox(SlotHandle handle);
+	// Refit a box in the tree and sweep and prune, after its world box changed
+	// (only on the main thread, outside of parallel updates)
+	void UpdateBox(SlotHandle handle);
+	// Removals in between are compacted all at once by the End call
+	void BeginBatchRemove();
+	void EndBatchRemove();
+
+	// Add/remove rigid bodies (add returns the handle to remove with)
+	SlotHandle AddBody(class RigidBodyComponent* body);
+	void RemoveBody(SlotHandle handle);
+	// Wake a sleeping body (and the rest of its island)
+	void WakeBody(class RigidBodyComponent* body);
+	// Advance the awake bodies by one fixed step: find their contacts,
+	// solve them with sequential impulses (warm started from last step),
+	// move the bodies, and put islands that have settled to sleep.
+	// Independent islands are solved in parallel on the job system.
+	void StepBodies(float deltaTime);
+	void SetGravity(const Vector3& gravity) { mGravity = gravity; }
+	size_t GetNumAwakeBodies() const { return mAwakeBodies.size(); }
+	size_t GetNumContacts() const { return mContacts.size(); }
+
+	// Bytes used by each broadphase structure
+	size_t GetTreeMemoryUsage() const { return mTree.GetMemoryUsage(); }
+	size_t GetSAPMemoryUsage() const { return mSAP.GetMemoryUsage(); }
+	size_t GetSoAMemoryUsage() const;
 private:
+	// Touching pair, where A is always a body (B is null for a still box)
+	struct Contact
+	{
+		class RigidBodyComponent* mBodyA;
+		class RigidBodyComponent* mBodyB;
+		ContactManifold mManifold;
+		Vector3 mTangent1;
+		Vector3 mTangent2;
+		// Accumulated impulses for each point
+		float mNormalImpulse[ContactManifold::MaxPoints];
+		float mTangentImpulse1[ContactManifold::MaxPoints];
+		float mTangentImpulse2[ContactManifold::MaxPoints];
+		// Separating velocity each point is solved toward
+		float mVelocityBias[ContactManifold::MaxPoints];
+		float mMass;
+		float mFriction;
+		float mRestitution;
+		// The pair's box proxy IDs (to find last step's impulses)
+		uint64_t mKey;
+	};
+	// Impulses saved from last step, for warm starting
+	struct CachedImpulses
+	{
+		int mNumPoints;
+		float mNormal[ContactManifold::MaxPoints];
+		float mTangent1[ContactManifold::MaxPoints];
+		float mTangent2[ContactManifold::MaxPoints];
+	};
+	// Segment cast, with the ends snapped to a grid
+	struct CastKey
+	{
+		int32_t mCoords[6];
+		uint32_t mLayers;
+
+		bool operator==(const CastKey& other) const;
+	};
+	struct CastKeyHash
+	{
+		size_t operator()(const CastKey& key) const;
+	};
+	struct CachedCast
+	{
+		CollisionInfo mInfo;
+		bool mHit;
+	};
+
+	// Bodies connected by contacts (indices into mIslandBodies and
+	// mIslandContacts)
+	struct Island
+	{
+		size_t mBodyStart;
+		size_t mNumBodies;
+		size_t mContactStart;
+		size_t mNumContacts;
+	};
+
+	static CastKey MakeCastKey(const LineSegment& l, uint32_t layers);
+	void FindContacts();
+	bool CollideShapes(class BoxComponent* a, class BoxComponent* b,
+		ContactManifold& m);
+	void BuildIslands();
+	void SolveIsland(const Island& island, float deltaTime);
+	// Returns true if the whole island is ready to sleep
+	bool UpdateSleep(const Island& island, float deltaTime);
+	// Links the island's bodies in a ring (StepBodies then removes
+	// every body in a ring from the awake list)
+	void SleepIsland(const Island& island);
+	void RemoveAwake(class RigidBodyComponent* body);
+
 	class Game* mGame;
-	std::vector<class BoxComponent*> mBoxes;
+	SlotMap<class BoxComponent*> mBoxes;
+	// Box tree for queries (leaf user data is the BoxComponent)
+	AABBTree mTree;
+	// Persistent sweep and prune (user data is also the BoxComponent)
+	SweepAndPrune mSAP;
+	// Rebuild the SoA copy of the boxes for batched casts (if changed)
+	void UpdateBoxSoA();
+	// World box min/max for each box, padded to a multiple of 4
+	std::vector<float> mSoAMin[3];
+	std::vector<float> mSoAMax[3];
+	std::vector<class BoxComponent*> mSoABoxes;
+	bool mSoADirty;
+
+	std::unordered_map<CastKey, CachedCast, CastKeyHash> mCastCache;
+
+	SlotMap<class RigidBodyComponent*> mBodies;
+	// Only these are simulated (each knows its index in here)
+	std::vector<class RigidBodyComponent*> mAwakeBodies;
+	std::vector<Contact> mContacts;
+	std::unordered_map<uint64_t, CachedImpulses> mImpulseCache;
+	std::unordered_map<uint64_t, CachedImpulses> mNextImpulseCache;
+	std::vector<Island> mIslands;
+	std::vector<int> mIslandBodies;
+	std::vector<int> mIslandContacts;
+	// Union-find over awake body indices
+	std::vector<int> mIslandParent;
+	std::vector<int> mIslandIndex;
+	// Set for islands that settled this step
+	std::vector<uint8_t> mIslandCanSleep;
+	Vector3 mGravity;
 };
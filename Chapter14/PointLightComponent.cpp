@@ -18,12 +18,12 @@
 PointLightComponent::PointLightComponent(Actor* owner)
 	:Component(owner)
 {
-	owner->GetGame()->GetRenderer()->AddPointLight(this);
+	mRenderHandle = owner->GetGame()->GetRenderer()->AddPointLight(this);
 }
 
 PointLightComponent::~PointLightComponent()
 {
-	mOwner->GetGame()->GetRenderer()->RemovePointLight(this);
+	mOwner->GetGame()->GetRenderer()->RemovePointLight(mRenderHandle);
 }
 
 void PointLightComponent::Draw(Shader* shader, Mesh* mesh)
@@ -33,13 +33,15 @@ void PointLightComponent::Draw(Shader* shader, Mesh* mesh)
 
 	// World transform is scaled to the outer radius (divided by the mesh radius)
 	// and positioned to the world position
-	Matrix4 scale = Matrix4::CreateScale(mOwner->GetScale() *
+	// (use the interpolated position, so the light keeps up with its owner)
+	Vector3 pos = mOwner->GetRenderTransform().GetTranslation();
+	Matrix4 scale = Matrix4::CreateScale(mOwner->GetWorldScale() *
 		mOuterRadius / mesh->GetRadius());
-	Matrix4 trans = Matrix4::CreateTranslation(mOwner->GetPosition());
+	Matrix4 trans = Matrix4::CreateTranslation(pos);
 	Matrix4 worldTransform = scale * trans;
 	shader->SetMatrixUniform("uWorldTransform", worldTransform);
 	// Set point light shader constants
-	shader->SetVectorUniform("uPointLight.mWorldPos", mOwner->GetPosition());
+	shader->SetVectorUniform("uPointLight.mWorldPos", pos);
 	shader->SetVectorUniform("uPointLight.mDiffuseColor", mDiffuseColor);
 	shader->SetFloatUniform("uPointLight.mInnerRadius", mInnerRadius);
 	shader->SetFloatUniform("uPointLight.mOuterRadius", mOuterRadius);
@@ -9,6 +9,7 @@
 #pragma once
 #include "Math.h"
 #include "Component.h"
+#include "SlotMap.h"
 
 class PointLightComponent : public Component
 {
@@ -30,4 +31,7 @@ public:
 	void LoadProperties(const rapidjson::Value& inObj) override;
 	void SaveProperties(rapidjson::Document::AllocatorType& alloc,
 		rapidjson::Value& inObj) const override;
+private:
+	// Handle in the renderer's point lights
+	SlotHandle mRenderHandle;
 };
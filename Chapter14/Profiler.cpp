@@ -0,0 +1,219 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <SDL/SDL_log.h>
+
+namespace
+{
+	// Events kept per thread (power of two)
+	const uint64_t RingSize = 16384;
+	const int MaxDepth = 32;
+	// Weight of the newest frame in the rolling average
+	const double AvgWeight = 1.0 / 30.0;
+
+	struct ThreadBuffer
+	{
+		ProfileEvent mEvents[RingSize];
+		// Events ever written (only the owner thread writes)
+		std::atomic<uint64_t> mWriteCount{ 0 };
+		// How far EndFrame has read (main thread only)
+		uint64_t mReadCount = 0;
+		// Open zones
+		const char* mNames[MaxDepth];
+		uint64_t mStarts[MaxDepth];
+		int mDepth = 0;
+		int mThreadID = 0;
+	};
+
+	std::mutex sBufferMutex;
+	std::vector<ThreadBuffer*> sBuffers;
+	thread_local ThreadBuffer* tBuffer = nullptr;
+	std::unordered_map<const char*, size_t> sStatIndices;
+	const auto sStartTime = std::chrono::steady_clock::now();
+
+	ThreadBuffer* GetThreadBuffer()
+	{
+		if (tBuffer == nullptr)
+		{
+			tBuffer = new ThreadBuffer();
+			std::lock_guard<std::mutex> lock(sBufferMutex);
+			tBuffer->mThreadID = static_cast<int>(sBuffers.size());
+			sBuffers.emplace_back(tBuffer);
+		}
+		return tBuffer;
+	}
+}
+
+std::atomic<bool> Profiler::sEnabled(false);
+std::vector<ProfileZoneStats> Profiler::sStats;
+
+uint64_t Profiler::GetTimeNs()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - sStartTime).count());
+}
+
+bool Profiler::BeginZone(const char* name)
+{
+	if (!GetIsEnabled())
+	{
+		return false;
+	}
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer->mDepth >= MaxDepth)
+	{
+		return false;
+	}
+	buffer->mNames[buffer->mDepth] = name;
+	buffer->mStarts[buffer->mDepth] = GetTimeNs();
+	buffer->mDepth++;
+	return true;
+}
+
+void Profiler::EndZone()
+{
+	uint64_t end = GetTimeNs();
+	ThreadBuffer* buffer = GetThreadBuffer();
+	buffer->mDepth--;
+
+	uint64_t count = buffer->mWriteCount.load(std::memory_order_relaxed);
+	ProfileEvent& e = buffer->mEvents[count & (RingSize - 1)];
+	e.mName = buffer->mNames[buffer->mDepth];
+	e.mStart = buffer->mStarts[buffer->mDepth];
+	e.mEnd = end;
+	e.mDepth = static_cast<uint32_t>(buffer->mDepth);
+	// Publish the event to the main thread
+	buffer->mWriteCount.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+	for (auto& stat : sStats)
+	{
+		stat.mLastMs = 0.0;
+		stat.mLastCalls = 0;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sBufferMutex);
+		for (auto buffer : sBuffers)
+		{
+			uint64_t count = buffer->mWriteCount.load(std::memory_order_acquire);
+			// Skip anything that was already overwritten
+			if (count - buffer->mReadCount > RingSize)
+			{
+				buffer->mReadCount = count - RingSize;
+			}
+
+			for (uint64_t i = buffer->mReadCount; i < count; i++)
+			{
+				const ProfileEvent& e = buffer->mEvents[i & (RingSize - 1)];
+				auto iter = sStatIndices.find(e.mName);
+				size_t index;
+				if (iter != sStatIndices.end())
+				{
+					index = iter->second;
+				}
+				else
+				{
+					index = sStats.size();
+					sStatIndices.emplace(e.mName, index);
+					sStats.emplace_back(ProfileZoneStats{ e.mName, 0.0, 0.0, 0 });
+				}
+				sStats[index].mLastMs += (e.mEnd - e.mStart) / 1000000.0;
+				sStats[index].mLastCalls++;
+			}
+			buffer->mReadCount = count;
+		}
+	}
+
+	for (auto& stat : sStats)
+	{
+		stat.mAvgMs += (stat.mLastMs - stat.mAvgMs) * AvgWeight;
+	}
+}
+
+bool Profiler::WriteChromeTrace(const std::string& fileName)
+{
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	writer.StartObject();
+	writer.Key("traceEvents");
+	writer.StartArray();
+	{
+		std::lock_guard<std::mutex> lock(sBufferMutex);
+		for (auto thread : sBuffers)
+		{
+			// Name the thread in the viewer
+			writer.StartObject();
+			writer.Key("name"); writer.String("thread_name");
+			writer.Key("ph"); writer.String("M");
+			writer.Key("pid"); writer.Int(0);
+			writer.Key("tid"); writer.Int(thread->mThreadID);
+			writer.Key("args");
+			writer.StartObject();
+			std::string name = "Thread " + std::to_string(thread->mThreadID);
+			writer.Key("name"); writer.String(name.c_str());
+			writer.EndObject();
+			writer.EndObject();
+
+			uint64_t count = thread->mWriteCount.load(std::memory_order_acquire);
+			uint64_t first = count > RingSize ? count - RingSize : 0;
+			for (uint64_t i = first; i < count; i++)
+			{
+				// Complete events, in microseconds
+				const ProfileEvent& e = thread->mEvents[i & (RingSize - 1)];
+				writer.StartObject();
+				writer.Key("name"); writer.String(e.mName);
+				writer.Key("ph"); writer.String("X");
+				writer.Key("pid"); writer.Int(0);
+				writer.Key("tid"); writer.Int(thread->mThreadID);
+				writer.Key("ts"); writer.Double(e.mStart / 1000.0);
+				writer.Key("dur"); writer.Double((e.mEnd - e.mStart) / 1000.0);
+				writer.EndObject();
+			}
+		}
+	}
+	writer.EndArray();
+	writer.Key("displayTimeUnit"); writer.String("ms");
+	writer.EndObject();
+
+	std::ofstream outFile(fileName);
+	if (!outFile.is_open())
+	{
+		SDL_Log("Failed to write profile %s", fileName.c_str());
+		return false;
+	}
+	outFile << buffer.GetString();
+	SDL_Log("Wrote profile %s", fileName.c_str());
+	return true;
+}
+
+void Profiler::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(sBufferMutex);
+	for (auto buffer : sBuffers)
+	{
+		delete buffer;
+	}
+	sBuffers.clear();
+	// Only this thread's pointer can be reset, so this has to run
+	// after every other thread that profiled has exited
+	tBuffer = nullptr;
+	sStatIndices.clear();
+	sStats.clear();
+}
@@ -0,0 +1,97 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+
+// One finished zone, as recorded
+struct ProfileEvent
+{
+	// Must be a string literal (zones are matched by pointer)
+	const char* mName;
+	// Nanoseconds since the profiler started
+	uint64_t mStart;
+	uint64_t mEnd;
+	// How many zones this one is nested in
+	uint32_t mDepth;
+};
+
+// Timing for all the zones of one name
+struct ProfileZoneStats
+{
+	const char* mName;
+	// Total time in the zone during the last frame (summed over threads)
+	double mLastMs;
+	// Rolling average of mLastMs
+	double mAvgMs;
+	// Times the zone was entered during the last frame
+	uint32_t mLastCalls;
+};
+
+// Records timed zones on any thread. Each thread writes into its own
+// ring buffer (so there's no locking per zone), and once a frame the
+// main thread folds the new events into per-zone rolling averages.
+// Only the newest events are kept, for the Chrome trace export.
+class Profiler
+{
+public:
+	// (job threads read this while the main thread toggles it, and
+	// nothing else is ordered by it, so relaxed is enough)
+	static void SetEnabled(bool enabled) { sEnabled.store(enabled, std::memory_order_relaxed); }
+	static bool GetIsEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+	// Returns false if nothing was started (profiler disabled), in
+	// which case EndZone must not be called
+	static bool BeginZone(const char* name);
+	static void EndZone();
+
+	// Main thread, once per frame (while job threads are idle)
+	static void EndFrame();
+
+	// Sorted by first appearance
+	static const std::vector<ProfileZoneStats>& GetStats() { return sStats; }
+
+	// Write the kept events in Chrome's trace format (load the file
+	// in chrome://tracing or https://ui.perfetto.dev)
+	static bool WriteChromeTrace(const std::string& fileName);
+
+	static uint64_t GetTimeNs();
+
+	// Free the per-thread buffers (once other threads are done)
+	static void Shutdown();
+private:
+	static std::atomic<bool> sEnabled;
+	static std::vector<ProfileZoneStats> sStats;
+};
+
+// Times its own lifetime as a zone
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name)
+		:mActive(Profiler::BeginZone(name))
+	{
+	}
+	~ProfileScope()
+	{
+		if (mActive)
+		{
+			Profiler::EndZone();
+		}
+	}
+private:
+	bool mActive;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// Time the rest of the enclosing scope
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
@@ -0,0 +1,230 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "RenderQueue.h"
+#include "MeshComponent.h"
+#include "Mesh.h"
+#include "Actor.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include <cstring>
+#include <GL/glew.h>
+
+namespace
+{
+	// Key layout, from the top bit down: shader (8 bits), vertex array
+	// (16), texture (16), and depth (24). The IDs are only for grouping,
+	// so it's fine if large ones wrap around.
+	const int ShaderShift = 56;
+	const int VertexArrayShift = 40;
+	const int TextureShift = 24;
+	const uint64_t ShaderMask = 0xFF;
+	const uint64_t IDMask = 0xFFFF;
+	// Shorter runs than this aren't worth an instanced draw
+	const size_t MinInstances = 2;
+	const UniformName SpecPowerName("uSpecPower");
+
+	uint64_t DepthBits(float depth)
+	{
+		// Positive floats sort the same as their bits do
+		if (!(depth > 0.0f))
+		{
+			return 0;
+		}
+		uint32_t bits;
+		memcpy(&bits, &depth, sizeof(bits));
+		return bits >> 8;
+	}
+}
+
+RenderQueue::RenderQueue()
+	:mInstanceBuffer(0)
+{
+	ResetStats();
+}
+
+void RenderQueue::Initialize()
+{
+	glGenBuffers(1, &mInstanceBuffer);
+}
+
+void RenderQueue::Shutdown()
+{
+	glDeleteBuffers(1, &mInstanceBuffer);
+	mInstanceBuffer = 0;
+}
+
+void RenderQueue::Clear()
+{
+	mItems.clear();
+}
+
+void RenderQueue::Add(MeshComponent* mesh, Shader* shader, float depth,
+	Shader* instancedShader)
+{
+	Texture* texture = mesh->GetTexture();
+	uint64_t textureID = texture ? texture->GetTextureID() : 0;
+	uint64_t key = ((shader->GetProgramID() & ShaderMask) << ShaderShift) |
+		((mesh->GetVertexArray()->GetID() & IDMask) << VertexArrayShift) |
+		((textureID & IDMask) << TextureShift) |
+		DepthBits(depth);
+	mItems.emplace_back(Item{ key, mesh, shader, instancedShader });
+}
+
+void RenderQueue::Draw()
+{
+	Sort();
+
+	// Split into runs, and upload every instanced run's transforms at once
+	mRunEnds.clear();
+	mInstanceTransforms.clear();
+	for (size_t start = 0; start < mItems.size(); start = mRunEnds.back())
+	{
+		size_t end = FindRunEnd(start);
+		if (end - start >= MinInstances)
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				mInstanceTransforms.emplace_back(mItems[i].mMesh->GetOwner()->GetRenderTransform());
+			}
+		}
+		mRunEnds.emplace_back(end);
+	}
+	if (!mInstanceTransforms.empty())
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, mInstanceTransforms.size() * sizeof(Matrix4),
+			mInstanceTransforms.data(), GL_STREAM_DRAW);
+	}
+
+	Shader* shader = nullptr;
+	VertexArray* va = nullptr;
+	Texture* texture = nullptr;
+	size_t start = 0;
+	size_t instanceOffset = 0;
+	for (size_t end : mRunEnds)
+	{
+		const Item& item = mItems[start];
+		size_t count = end - start;
+		bool instanced = count >= MinInstances;
+
+		Shader* s = instanced ? item.mInstancedShader : item.mShader;
+		if (s != shader)
+		{
+			shader = s;
+			shader->SetActive();
+			mStats.mShaderBinds++;
+		}
+		Texture* t = item.mMesh->GetTexture();
+		if (t && t != texture)
+		{
+			texture = t;
+			texture->SetActive();
+			mStats.mTextureBinds++;
+		}
+		VertexArray* v = item.mMesh->GetVertexArray();
+		if (v != va)
+		{
+			va = v;
+			va->SetActive();
+			mStats.mVertexArrayBinds++;
+		}
+
+		if (instanced)
+		{
+			// Same mesh for the whole run, so its uniforms are too
+			shader->SetFloatUniform(SpecPowerName, item.mMesh->GetMesh()->GetSpecPower());
+			va->SetInstanceBuffer(mInstanceBuffer, instanceOffset * sizeof(Matrix4));
+			glDrawElementsInstanced(GL_TRIANGLES, va->GetNumIndices(), GL_UNSIGNED_INT,
+				nullptr, static_cast<GLsizei>(count));
+			va->ClearInstanceBuffer();
+			instanceOffset += count;
+			mStats.mDrawCalls++;
+			mStats.mInstancedDrawCalls++;
+			mStats.mInstances += static_cast<uint32_t>(count);
+		}
+		else
+		{
+			for (size_t i = start; i < end; i++)
+			{
+				mItems[i].mMesh->SetDrawUniforms(shader);
+				glDrawElements(GL_TRIANGLES, va->GetNumIndices(), GL_UNSIGNED_INT, nullptr);
+				mStats.mDrawCalls++;
+			}
+		}
+		start = end;
+	}
+}
+
+size_t RenderQueue::FindRunEnd(size_t start) const
+{
+	const Item& first = mItems[start];
+	size_t end = start + 1;
+	if (!first.mInstancedShader)
+	{
+		return end;
+	}
+
+	// Sorting put matching items next to each other (the key's IDs can
+	// wrap around, so check the real objects)
+	Texture* texture = first.mMesh->GetTexture();
+	VertexArray* va = first.mMesh->GetVertexArray();
+	while (end < mItems.size() &&
+		mItems[end].mShader == first.mShader &&
+		mItems[end].mInstancedShader == first.mInstancedShader &&
+		mItems[end].mMesh->GetVertexArray() == va &&
+		mItems[end].mMesh->GetTexture() == texture)
+	{
+		end++;
+	}
+	return end;
+}
+
+void RenderQueue::ResetStats()
+{
+	memset(&mStats, 0, sizeof(mStats));
+}
+
+void RenderQueue::Sort()
+{
+	// LSD radix sort, a byte at a time (stable, so each pass keeps the
+	// order from the less significant bytes)
+	size_t count = mItems.size();
+	if (count < 2)
+	{
+		return;
+	}
+	mSorted.resize(count);
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t offsets[256] = { 0 };
+		for (const Item& item : mItems)
+		{
+			offsets[(item.mKey >> shift) & 0xFF]++;
+		}
+		// Every key has the same byte here, so this pass wouldn't move anything
+		if (offsets[(mItems[0].mKey >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t total = 0;
+		for (size_t& offset : offsets)
+		{
+			size_t n = offset;
+			offset = total;
+			total += n;
+		}
+		for (const Item& item : mItems)
+		{
+			mSorted[offsets[(item.mKey >> shift) & 0xFF]++] = item;
+		}
+		mItems.swap(mSorted);
+	}
+}
@@ -0,0 +1,72 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Math.h"
+
+// Mesh draws for one pass, sorted by a 64-bit key so that items using
+// the same shader, vertex array and texture are next to each other
+// (front to back within those). Drawing only binds the state that
+// differs from the item before, and runs of the same mesh and texture
+// are drawn in one instanced call (if the item has an instanced shader).
+class RenderQueue
+{
+public:
+	// GL calls made by Draw (added up until Reset)
+	struct Stats
+	{
+		uint32_t mDrawCalls;
+		// Draw calls that were instanced, and the instances they drew
+		uint32_t mInstancedDrawCalls;
+		uint32_t mInstances;
+		uint32_t mShaderBinds;
+		uint32_t mVertexArrayBinds;
+		uint32_t mTextureBinds;
+	};
+
+	RenderQueue();
+
+	// Create/destroy the instance buffer (needs a GL context)
+	void Initialize();
+	void Shutdown();
+
+	void Clear();
+	// depth is the distance in front of the camera. The instanced shader
+	// (if any) takes the world transform as a per-instance attribute.
+	void Add(class MeshComponent* mesh, class Shader* shader, float depth,
+		class Shader* instancedShader = nullptr);
+	// Sort by key (radix sort), then draw everything in order
+	void Draw();
+
+	const Stats& GetStats() const { return mStats; }
+	void ResetStats();
+private:
+	struct Item
+	{
+		uint64_t mKey;
+		class MeshComponent* mMesh;
+		class Shader* mShader;
+		class Shader* mInstancedShader;
+	};
+
+	void Sort();
+	// End of the run of items that can be instanced with item start
+	// (just start + 1 if it can't be)
+	size_t FindRunEnd(size_t start) const;
+
+	std::vector<Item> mItems;
+	// Scratch for the radix sort
+	std::vector<Item> mSorted;
+	// Where each run of items ends, and the instanced runs' transforms
+	std::vector<size_t> mRunEnds;
+	std::vector<Matrix4> mInstanceTransforms;
+	unsigned int mInstanceBuffer;
+	Stats mStats;
+};
@@ -18,14 +18,126 @@
 #include "Game.h"
 #include <GL/glew.h>
 #include "SkeletalMeshComponent.h"
+#include "Profiler.h"
 #include "GBuffer.h"
 #include "PointLightComponent.h"
+#include "Collision.h"
+#include "Actor.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RENDER_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	// Matches the std140 layout of ViewBlock in the shaders
+	struct ViewBlockData
+	{
+		Matrix4 mViewProj;
+	};
+	// Matches the std140 layout of LightBlock in the shaders
+	// (each vec3 takes up 16 bytes)
+	struct LightBlockData
+	{
+		Vector3 mCameraPos;
+		float mPad0;
+		Vector3 mAmbientLight;
+		float mPad1;
+		Vector3 mDirection;
+		float mPad2;
+		Vector3 mDiffuseColor;
+		float mPad3;
+		Vector3 mSpecColor;
+		float mPad4;
+	};
+	static_assert(sizeof(ViewBlockData) == 64, "ViewBlockData must match std140");
+	static_assert(sizeof(LightBlockData) == 80, "LightBlockData must match std140");
+
+	const GLuint ViewBlockBinding = 0;
+	const GLuint LightBlockBinding = 1;
+
+	enum CullResult
+	{
+		ECullOutside,
+		ECullIntersect,
+		ECullInside
+	};
+
+	// Test spheres (x, y, z, and radius arrays, padded to a multiple of
+	// 4) against the frustum, 4 at a time
+	void CullSpheres(const Frustum& f, const std::vector<float> spheres[4],
+		size_t count, uint8_t* outResults)
+	{
+#ifdef RENDER_USE_SSE
+		__m128 zero = _mm_setzero_ps();
+		for (size_t i = 0; i < count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&spheres[0][i]);
+			__m128 y = _mm_loadu_ps(&spheres[1][i]);
+			__m128 z = _mm_loadu_ps(&spheres[2][i]);
+			__m128 r = _mm_loadu_ps(&spheres[3][i]);
+			__m128 negR = _mm_sub_ps(zero, r);
+			__m128 outside = zero;
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (const Plane& p : f.mPlanes)
+			{
+				__m128 dist = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(p.mNormal.x)),
+					_mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(p.mNormal.y)),
+					_mm_mul_ps(z, _mm_set1_ps(p.mNormal.z))));
+				dist = _mm_sub_ps(dist, _mm_set1_ps(p.mD));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negR));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, r));
+			}
+			int outsideMask = _mm_movemask_ps(outside);
+			int insideMask = _mm_movemask_ps(inside);
+			for (int j = 0; j < 4; j++)
+			{
+				if (outsideMask & (1 << j))
+				{
+					outResults[i + j] = ECullOutside;
+				}
+				else
+				{
+					outResults[i + j] = (insideMask & (1 << j)) ? ECullInside : ECullIntersect;
+				}
+			}
+		}
+#else
+		for (size_t i = 0; i < count; i++)
+		{
+			Vector3 center(spheres[0][i], spheres[1][i], spheres[2][i]);
+			float r = spheres[3][i];
+			uint8_t result = ECullInside;
+			for (const Plane& p : f.mPlanes)
+			{
+				float dist = p.SignedDist(center);
+				if (dist < -r)
+				{
+					result = ECullOutside;
+					break;
+				}
+				if (dist < r)
+				{
+					result = ECullIntersect;
+				}
+			}
+			outResults[i] = result;
+		}
+#endif
+	}
+}
 
 Renderer::Renderer(Game* game)
-	:mGame(game)
+	:mSortSprites(false)
+	,mGame(game)
 	,mSpriteShader(nullptr)
 	,mMeshShader(nullptr)
+	,mInstancedMeshShader(nullptr)
 	,mSkinnedShader(nullptr)
+	,mHasPrevView(false)
+	,mViewBuffer(0)
+	,mLightBuffer(0)
 	,mMirrorBuffer(0)
 	,mMirrorTexture(nullptr)
 	,mGBuffer(nullptr)
@@ -93,6 +205,22 @@ bool Renderer::Initialize(float screenWidth, float screenHeight)
 	// Create quad for drawing sprites
 	CreateSpriteVerts();
 
+	// Create the render queue's instance buffer
+	mRenderQueue.Initialize();
+	// Create the sprite batch's buffers
+	mSpriteBatch.Initialize();
+
+	// Create the per-view uniform buffers (every shader with the block
+	// reads them from its binding point)
+	glGenBuffers(1, &mViewBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, mViewBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewBlockData), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, ViewBlockBinding, mViewBuffer);
+	glGenBuffers(1, &mLightBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, mLightBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlockData), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, LightBlockBinding, mLightBuffer);
+
 	// Create render target for mirror
 	//if (!CreateMirrorTarget())
 	//{
@@ -132,15 +260,21 @@ void Renderer::Shutdown()
 		delete mGBuffer;
 	}
 	// Delete point lights
-	while (!mPointLights.empty())
+	while (!mPointLights.Empty())
 	{
-		delete mPointLights.back();
+		delete mPointLights.Back();
 	}
 	delete mSpriteVerts;
 	mSpriteShader->Unload();
 	delete mSpriteShader;
 	mMeshShader->Unload();
 	delete mMeshShader;
+	mInstancedMeshShader->Unload();
+	delete mInstancedMeshShader;
+	mRenderQueue.Shutdown();
+	mSpriteBatch.Shutdown();
+	glDeleteBuffers(1, &mViewBuffer);
+	glDeleteBuffers(1, &mLightBuffer);
 	SDL_GL_DeleteContext(mContext);
 	SDL_DestroyWindow(mWindow);
 }
@@ -166,10 +300,29 @@ void Renderer::UnloadData()
 
 void Renderer::Draw()
 {
+	PROFILE_SCOPE("Renderer::Draw");
+	mRenderQueue.ResetStats();
+	mSpriteBatch.ResetStats();
+	// Blend the camera between the last two ticks, like the actors
+	// (the change per tick is small, so a per-element blend is fine)
+	mRenderView = mView;
+	if (mHasPrevView)
+	{
+		float alpha = mGame->GetInterpolationAlpha();
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				mRenderView.mat[i][j] = Math::Lerp(mPrevView.mat[i][j],
+					mView.mat[i][j], alpha);
+			}
+		}
+	}
+
 	// Draw to the mirror texture first
 	//Draw3DScene(mMirrorBuffer, mMirrorView, mProjection);
 	// Draw the 3D scene to the G-buffer
-	Draw3DScene(mGBuffer->GetBufferID(), mView, mProjection, false);
+	Draw3DScene(mGBuffer->GetBufferID(), mRenderView, mProjection);
 	// Set the frame buffer back to zero (screen's frame buffer)
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	// Draw from the GBuffer
@@ -183,90 +336,106 @@ void Renderer::Draw()
 	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
 	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
 
-	// Set shader/vao as active
+	// Removals don't keep the draw order, so re-sort if anything changed
+	if (mSortSprites)
+	{
+		mSprites.Sort([](const SpriteComponent* a, const SpriteComponent* b) {
+			return a->GetDrawOrder() < b->GetDrawOrder();
+		});
+		mSortSprites = false;
+	}
+
+	// Set shader as active (the sprite batch has its own vao)
 	mSpriteShader->SetActive();
-	mSpriteVerts->SetActive();
 	for (auto sprite : mSprites)
 	{
 		if (sprite->GetVisible())
 		{
-			sprite->Draw(mSpriteShader);
+			sprite->Draw(&mSpriteBatch);
 		}
 	}
 	
 	// Draw any UI screens
-	for (auto ui : mGame->GetUIStack())
 	{
-		ui->Draw(mSpriteShader);
+		PROFILE_SCOPE("Renderer::DrawUI");
+		for (auto ui : mGame->GetUIStack())
+		{
+			ui->Draw(&mSpriteBatch);
+		}
+		// Sprites and UI are drawn together, in the order they were added
+		mSpriteBatch.Flush();
 	}
 
 	// Swap the buffers
 	SDL_GL_SwapWindow(mWindow);
 }
 
-void Renderer::AddSprite(SpriteComponent* sprite)
+SlotHandle Renderer::AddSprite(SpriteComponent* sprite)
 {
-	// Find the insertion point in the sorted vector
-	// (The first element with a higher draw order than me)
-	int myDrawOrder = sprite->GetDrawOrder();
-	auto iter = mSprites.begin();
-	for (;
-		iter != mSprites.end();
-		++iter)
-	{
-		if (myDrawOrder < (*iter)->GetDrawOrder())
-		{
-			break;
-		}
-	}
-
-	// Inserts element before position of iterator
-	mSprites.insert(iter, sprite);
+	// Sorted by draw order before the next draw
+	mSortSprites = true;
+	return mSprites.Insert(sprite);
 }
 
-void Renderer::RemoveSprite(SpriteComponent* sprite)
+void Renderer::RemoveSprite(SlotHandle handle)
 {
-	auto iter = std::find(mSprites.begin(), mSprites.end(), sprite);
-	mSprites.erase(iter);
+	// The last sprite moves into the hole, so the order changes
+	// (unless it's a batch removal, which keeps the order)
+	if (mSprites.Remove(handle) && !mSprites.GetIsBatchRemoving())
+	{
+		mSortSprites = true;
+	}
 }
 
-void Renderer::AddMeshComp(MeshComponent* mesh)
+SlotHandle Renderer::AddMeshComp(MeshComponent* mesh)
 {
 	if (mesh->GetIsSkeletal())
 	{
 		SkeletalMeshComponent* sk = static_cast<SkeletalMeshComponent*>(mesh);
-		mSkeletalMeshes.emplace_back(sk);
+		return mSkeletalMeshes.Insert(sk);
 	}
 	else
 	{
-		mMeshComps.emplace_back(mesh);
+		return mMeshComps.Insert(mesh);
 	}
 }
 
-void Renderer::RemoveMeshComp(MeshComponent* mesh)
+void Renderer::RemoveMeshComp(SlotHandle handle, bool isSkeletal)
 {
-	if (mesh->GetIsSkeletal())
+	if (isSkeletal)
 	{
-		SkeletalMeshComponent* sk = static_cast<SkeletalMeshComponent*>(mesh);
-		auto iter = std::find(mSkeletalMeshes.begin(), mSkeletalMeshes.end(), sk);
-		mSkeletalMeshes.erase(iter);
+		mSkeletalMeshes.Remove(handle);
 	}
 	else
 	{
-		auto iter = std::find(mMeshComps.begin(), mMeshComps.end(), mesh);
-		mMeshComps.erase(iter);
+		mMeshComps.Remove(handle);
 	}
 }
 
-void Renderer::AddPointLight(PointLightComponent * light)
+SlotHandle Renderer::AddPointLight(PointLightComponent * light)
 {
-	mPointLights.emplace_back(light);
+	return mPointLights.Insert(light);
 }
 
-void Renderer::RemovePointLight(PointLightComponent * light)
+void Renderer::RemovePointLight(SlotHandle handle)
 {
-	auto iter = std::find(mPointLights.begin(), mPointLights.end(), light);
-	mPointLights.erase(iter);
+	mPointLights.Remove(handle);
+}
+
+void Renderer::BeginBatchRemove()
+{
+	mSprites.BeginBatchRemove();
+	mMeshComps.BeginBatchRemove();
+	mSkeletalMeshes.BeginBatchRemove();
+	mPointLights.BeginBatchRemove();
+}
+
+void Renderer::EndBatchRemove()
+{
+	mSprites.EndBatchRemove();
+	mMeshComps.EndBatchRemove();
+	mSkeletalMeshes.EndBatchRemove();
+	mPointLights.EndBatchRemove();
 }
 
 Texture* Renderer::GetTexture(const std::string& fileName)
@@ -317,8 +486,9 @@ Mesh* Renderer::GetMesh(const std::string & fileName)
 	return m;
 }
 
-void Renderer::Draw3DScene(unsigned int framebuffer, const Matrix4& view, const Matrix4& proj, bool lit)
+void Renderer::Draw3DScene(unsigned int framebuffer, const Matrix4& view, const Matrix4& proj)
 {
+	PROFILE_SCOPE("Renderer::Draw3DScene");
 	// Set the current frame buffer
 	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 	// Clear color buffer/depth buffer
@@ -330,37 +500,115 @@ void Renderer::Draw3DScene(unsigned int framebuffer, const Matrix4& view, const
 	// Enable depth buffering/disable alpha blend
 	glEnable(GL_DEPTH_TEST);
 	glDisable(GL_BLEND);
-	// Set the mesh shader active
-	mMeshShader->SetActive();
-	// Update view-projection matrix
-	mMeshShader->SetMatrixUniform("uViewProj", view * proj);
-	// Update lighting uniforms
-	if (lit)
+	// Only draw what this view can see
+	Matrix4 viewProj = view * proj;
+	CullMeshes(viewProj);
+
+	// Per-view uniforms (uploaded once, for every shader)
+	UpdateViewBlocks(view, viewProj);
+
+	// Queue the visible meshes (with their depth, which is clip space w),
+	// and draw them sorted by state (non-skinned meshes that repeat are
+	// instanced)
+	mRenderQueue.Clear();
+	Vector3 depthAxis(viewProj.mat[0][3], viewProj.mat[1][3], viewProj.mat[2][3]);
+	for (auto mc : mVisibleMeshes)
 	{
-		SetLightUniforms(mMeshShader, view);
+		Vector3 center = mc->GetWorldSphere().mCenter + GetRenderOffset(mc);
+		float depth = Vector3::Dot(center, depthAxis) + viewProj.mat[3][3];
+		mRenderQueue.Add(mc, mMeshShader, depth, mInstancedMeshShader);
 	}
+	for (auto sk : mVisibleSkinned)
+	{
+		Vector3 center = sk->GetWorldSphere().mCenter + GetRenderOffset(sk);
+		float depth = Vector3::Dot(center, depthAxis) + viewProj.mat[3][3];
+		mRenderQueue.Add(sk, mSkinnedShader, depth);
+	}
+	mRenderQueue.Draw();
+}
+
+Vector3 Renderer::GetRenderOffset(MeshComponent* mc) const
+{
+	Actor* owner = mc->GetOwner();
+	return owner->GetRenderTransform().GetTranslation() -
+		owner->GetWorldTransform().GetTranslation();
+}
+
+void Renderer::CullMeshes(const Matrix4& viewProj)
+{
+	PROFILE_SCOPE("Renderer::CullMeshes");
+	Frustum frustum(viewProj);
+
+	// Everything that would draw (non-skinned first, then skinned)
+	mCullMeshes.clear();
 	for (auto mc : mMeshComps)
 	{
-		if (mc->GetVisible())
+		if (mc->GetVisible() && mc->GetHasMesh())
+		{
+			mCullMeshes.emplace_back(mc);
+		}
+	}
+	size_t numStatic = mCullMeshes.size();
+	for (auto sk : mSkeletalMeshes)
+	{
+		if (sk->GetVisible() && sk->GetHasMesh())
 		{
-			mc->Draw(mMeshShader);
+			mCullMeshes.emplace_back(sk);
 		}
 	}
 
-	// Draw any skinned meshes now
-	mSkinnedShader->SetActive();
-	// Update view-projection matrix
-	mSkinnedShader->SetMatrixUniform("uViewProj", view * proj);
-	// Update lighting uniforms
-	if (lit)
+	size_t count = mCullMeshes.size();
+	size_t padded = (count + 3) & ~static_cast<size_t>(3);
+	for (int a = 0; a < 4; a++)
 	{
-		SetLightUniforms(mSkinnedShader, view);
+		mCullSpheres[a].resize(padded);
 	}
-	for (auto sk : mSkeletalMeshes)
+	for (size_t i = 0; i < count; i++)
 	{
-		if (sk->GetVisible())
+		// Meshes draw with the blended render transform, so cull them
+		// there (and not where the last tick left them)
+		const Sphere& s = mCullMeshes[i]->GetWorldSphere();
+		Vector3 center = s.mCenter + GetRenderOffset(mCullMeshes[i]);
+		mCullSpheres[0][i] = center.x;
+		mCullSpheres[1][i] = center.y;
+		mCullSpheres[2][i] = center.z;
+		mCullSpheres[3][i] = s.mRadius;
+	}
+	for (size_t i = count; i < padded; i++)
+	{
+		for (int a = 0; a < 4; a++)
+		{
+			mCullSpheres[a][i] = 0.0f;
+		}
+	}
+	mCullResults.resize(padded);
+	CullSpheres(frustum, mCullSpheres, padded, mCullResults.data());
+
+	mVisibleMeshes.clear();
+	mVisibleSkinned.clear();
+	for (size_t i = 0; i < count; i++)
+	{
+		// Spheres crossing a plane get a closer look with the box
+		MeshComponent* mc = mCullMeshes[i];
+		bool visible = mCullResults[i] == ECullInside;
+		if (mCullResults[i] == ECullIntersect)
 		{
-			sk->Draw(mSkinnedShader);
+			AABB box = mc->GetWorldBox();
+			Vector3 offset = GetRenderOffset(mc);
+			box.mMin += offset;
+			box.mMax += offset;
+			visible = Intersect(frustum, box);
+		}
+		if (visible)
+		{
+			if (i < numStatic)
+			{
+				mVisibleMeshes.emplace_back(mc);
+			}
+			else
+			{
+				mVisibleSkinned.emplace_back(mc);
+			}
 		}
 	}
 }
@@ -407,6 +655,7 @@ bool Renderer::CreateMirrorTarget()
 
 void Renderer::DrawFromGBuffer()
 {
+	PROFILE_SCOPE("Renderer::DrawFromGBuffer");
 	// Clear the current framebuffer
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -419,8 +668,7 @@ void Renderer::DrawFromGBuffer()
 	mSpriteVerts->SetActive();
 	// Set the G-buffer textures to sample
 	mGBuffer->SetTexturesActive();
-	// Set the lighting uniforms
-	SetLightUniforms(mGGlobalShader, mView);
+	// (the lighting uniforms are still in the blocks from Draw3DScene)
 	// Draw the triangles
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 
@@ -439,9 +687,6 @@ void Renderer::DrawFromGBuffer()
 	// Set the point light shader and mesh as active
 	mGPointLightShader->SetActive();
 	mPointLightMesh->GetVertexArray()->SetActive();
-	// Set the view-projeciton matrix
-	mGPointLightShader->SetMatrixUniform("uViewProj",
-		mView * mProjection);
 	// Set the G-buffer textures for sampling
 	mGBuffer->SetTexturesActive();
 
@@ -477,12 +722,17 @@ bool Renderer::LoadShaders()
 		return false;
 	}
 
-	mMeshShader->SetActive();
-	// Set the view-projection matrix
+	// Set the view-projection matrix (Draw3DScene uploads it)
 	mView = Matrix4::CreateLookAt(Vector3::Zero, Vector3::UnitX, Vector3::UnitZ);
 	mProjection = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
 		mScreenWidth, mScreenHeight, 10.0f, 10000.0f);
-	mMeshShader->SetMatrixUniform("uViewProj", mView * mProjection);
+
+	// Same, but with a world transform for each instance
+	mInstancedMeshShader = new Shader();
+	if (!mInstancedMeshShader->Load("Shaders/PhongInstanced.vert", "Shaders/GBufferWrite.frag"))
+	{
+		return false;
+	}
 
 	// Create skinned shader
 	mSkinnedShader = new Shader();
@@ -490,9 +740,6 @@ bool Renderer::LoadShaders()
 	{
 		return false;
 	}
-
-	mSkinnedShader->SetActive();
-	mSkinnedShader->SetMatrixUniform("uViewProj", mView * mProjection);
 	
 	// Create shader for drawing from GBuffer (global lighting)
 	mGGlobalShader = new Shader();
@@ -526,6 +773,15 @@ bool Renderer::LoadShaders()
 	mGPointLightShader->SetIntUniform("uGWorldPos", 2);
 	mGPointLightShader->SetVector2Uniform("uScreenDimensions",
 		Vector2(mScreenWidth, mScreenHeight));
+
+	// Point the shaders' per-view blocks at the shared buffers
+	Shader* blockShaders[] = { mMeshShader, mInstancedMeshShader, mSkinnedShader,
+		mGGlobalShader, mGPointLightShader };
+	for (Shader* shader : blockShaders)
+	{
+		shader->BindUniformBlock("ViewBlock", ViewBlockBinding);
+		shader->BindUniformBlock("LightBlock", LightBlockBinding);
+	}
 	return true;
 }
 
@@ -546,21 +802,26 @@ void Renderer::CreateSpriteVerts()
 	mSpriteVerts = new VertexArray(vertices, 4, VertexArray::PosNormTex, indices, 6);
 }
 
-void Renderer::SetLightUniforms(Shader* shader, const Matrix4& view)
+void Renderer::UpdateViewBlocks(const Matrix4& view, const Matrix4& viewProj)
 {
+	ViewBlockData viewData;
+	viewData.mViewProj = viewProj;
+	glBindBuffer(GL_UNIFORM_BUFFER, mViewBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(viewData), &viewData);
+
+	LightBlockData lightData = {};
 	// Camera position is from inverted view
 	Matrix4 invView = view;
 	invView.Invert();
-	shader->SetVectorUniform("uCameraPos", invView.GetTranslation());
+	lightData.mCameraPos = invView.GetTranslation();
 	// Ambient light
-	shader->SetVectorUniform("uAmbientLight", mAmbientLight);
+	lightData.mAmbientLight = mAmbientLight;
 	// Directional light
-	shader->SetVectorUniform("uDirLight.mDirection",
-		mDirLight.mDirection);
-	shader->SetVectorUniform("uDirLight.mDiffuseColor",
-		mDirLight.mDiffuseColor);
-	shader->SetVectorUniform("uDirLight.mSpecColor",
-		mDirLight.mSpecColor);
+	lightData.mDirection = mDirLight.mDirection;
+	lightData.mDiffuseColor = mDirLight.mDiffuseColor;
+	lightData.mSpecColor = mDirLight.mSpecColor;
+	glBindBuffer(GL_UNIFORM_BUFFER, mLightBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(lightData), &lightData);
 }
 
 Vector3 Renderer::Unproject(const Vector3& screenPoint) const
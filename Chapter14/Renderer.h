@@ -12,6 +12,9 @@
 #include <unordered_map>
 #include <SDL/SDL.h>
 #include "Math.h"
+#include "SlotMap.h"
+#include "RenderQueue.h"
+#include "SpriteBatch.h"
 
 struct DirectionalLight
 {
@@ -27,32 +30,42 @@ class Renderer
 {
 public:
 	Renderer(class Game* game);
-	~Renderer();
+	virtual ~Renderer();
 
-	bool Initialize(float screenWidth, float screenHeight);
-	void Shutdown();
+	virtual bool Initialize(float screenWidth, float screenHeight);
+	virtual void Shutdown();
 	void UnloadData();
 
-	void Draw();
+	virtual void Draw();
 
-	void AddSprite(class SpriteComponent* sprite);
-	void RemoveSprite(class SpriteComponent* sprite);
+	// Add returns the handle to pass to Remove later
+	SlotHandle AddSprite(class SpriteComponent* sprite);
+	void RemoveSprite(SlotHandle handle);
 
-	void AddMeshComp(class MeshComponent* mesh);
-	void RemoveMeshComp(class MeshComponent* mesh);
+	SlotHandle AddMeshComp(class MeshComponent* mesh);
+	void RemoveMeshComp(SlotHandle handle, bool isSkeletal);
 
-	void AddPointLight(class PointLightComponent* light);
-	void RemovePointLight(class PointLightComponent* light);
+	SlotHandle AddPointLight(class PointLightComponent* light);
+	void RemovePointLight(SlotHandle handle);
 
-	class Texture* GetTexture(const std::string& fileName);
+	// Removals in between are compacted all at once by the End call
+	void BeginBatchRemove();
+	void EndBatchRemove();
+
+	virtual class Texture* GetTexture(const std::string& fileName);
 	class Mesh* GetMesh(const std::string& fileName);
 
+	// True if there's no window/GL context (assets stay CPU-side)
+	virtual bool GetIsHeadless() const { return false; }
+
 	void SetViewMatrix(const Matrix4& view) { mView = view; }
+	// Snapshot the view at the start of a simulation tick
+	void StorePrevView() { mPrevView = mView; mHasPrevView = true; }
 
 	const Vector3& GetAmbientLight() const { return mAmbientLight; }
 	void SetAmbientLight(const Vector3& ambient) { mAmbientLight = ambient; }
 	DirectionalLight& GetDirectionalLight() { return mDirLight; }
-	const std::vector<class PointLightComponent*>& GetPointLights() const { return mPointLights; }
+	const std::vector<class PointLightComponent*>& GetPointLights() const { return mPointLights.GetDense(); }
 
 	// Given a screen space point, unprojects it into world space,
 	// based on the current 3D view/projection matrices
@@ -71,16 +84,28 @@ public:
 	void SetMirrorView(const Matrix4& view) { mMirrorView = view; }
 	class Texture* GetMirrorTexture() { return mMirrorTexture; }
 	class GBuffer* GetGBuffer() { return mGBuffer; }
-private:
+	// Binds and draw calls the render queue made in the last frame
+	const RenderQueue::Stats& GetRenderStats() const { return mRenderQueue.GetStats(); }
+	// Draw calls and sprites the sprite batch drew in the last frame
+	const SpriteBatch::Stats& GetSpriteStats() const { return mSpriteBatch.GetStats(); }
+protected:
 	// Chapter 14 additions
-	void Draw3DScene(unsigned int framebuffer, const Matrix4& view, const Matrix4& proj, bool lit = true);
+	void Draw3DScene(unsigned int framebuffer, const Matrix4& view, const Matrix4& proj);
 	bool CreateMirrorTarget();
 	void DrawFromGBuffer();
 	//void DrawFromGBuffer();
 	// End chapter 14 additions
 	bool LoadShaders();
 	void CreateSpriteVerts();
-	void SetLightUniforms(class Shader* shader, const Matrix4& view);
+	// Upload the view-projection, camera, and lights to the shaders'
+	// shared uniform blocks
+	void UpdateViewBlocks(const Matrix4& view, const Matrix4& viewProj);
+	// Find the meshes inside the view frustum (into mVisibleMeshes and
+	// mVisibleSkinned)
+	void CullMeshes(const Matrix4& viewProj);
+	// How far the mesh's render transform is from its world transform
+	// (its bounds are at the world transform)
+	Vector3 GetRenderOffset(class MeshComponent* mc) const;
 
 	// Map of textures loaded
 	std::unordered_map<std::string, class Texture*> mTextures;
@@ -88,28 +113,48 @@ private:
 	std::unordered_map<std::string, class Mesh*> mMeshes;
 
 	// All the sprite components drawn
-	std::vector<class SpriteComponent*> mSprites;
+	SlotMap<class SpriteComponent*> mSprites;
+	// Set when sprites need sorting by draw order again
+	bool mSortSprites;
 
 	// All (non-skeletal) mesh components drawn
-	std::vector<class MeshComponent*> mMeshComps;
-	std::vector<class SkeletalMeshComponent*> mSkeletalMeshes;
+	SlotMap<class MeshComponent*> mMeshComps;
+	SlotMap<class SkeletalMeshComponent*> mSkeletalMeshes;
+	// Meshes that passed culling for the current 3D pass
+	std::vector<class MeshComponent*> mVisibleMeshes;
+	std::vector<class MeshComponent*> mVisibleSkinned;
+	// Scratch for culling: the candidates, their bounding spheres
+	// (x, y, z, radius, each padded to a multiple of 4), and results
+	std::vector<class MeshComponent*> mCullMeshes;
+	std::vector<float> mCullSpheres[4];
+	std::vector<uint8_t> mCullResults;
+	// Sorts the visible meshes' draws by state
+	RenderQueue mRenderQueue;
 
 	// Game
 	class Game* mGame;
 
 	// Sprite shader
 	class Shader* mSpriteShader;
-	// Sprite vertex array
+	// Sprite vertex array (the G-buffer's full screen quad)
 	class VertexArray* mSpriteVerts;
+	// Sprites and UI textures, drawn a texture at a time
+	SpriteBatch mSpriteBatch;
 
 	// Mesh shader
 	class Shader* mMeshShader;
+	// Mesh shader reading the world transform per instance
+	class Shader* mInstancedMeshShader;
 	// Skinned shader
 	class Shader* mSkinnedShader;
 
 	// View/projection for 3D shaders
 	Matrix4 mView;
 	Matrix4 mProjection;
+	// View as of the previous tick, and the blend of the two we draw with
+	Matrix4 mPrevView;
+	Matrix4 mRenderView;
+	bool mHasPrevView;
 
 	// Lighting data
 	Vector3 mAmbientLight;
@@ -123,6 +168,10 @@ private:
 	float mScreenWidth;
 	float mScreenHeight;
 
+	// Uniform buffers behind ViewBlock and LightBlock
+	unsigned int mViewBuffer;
+	unsigned int mLightBuffer;
+
 	unsigned int mMirrorBuffer;
 	class Texture* mMirrorTexture;
 	Matrix4 mMirrorView;
@@ -131,6 +180,6 @@ private:
 	// GBuffer shader
 	class Shader* mGGlobalShader;
 	class Shader* mGPointLightShader;
-	std::vector<class PointLightComponent*> mPointLights;
+	SlotMap<class PointLightComponent*> mPointLights;
 	class Mesh* mPointLightMesh;
 };
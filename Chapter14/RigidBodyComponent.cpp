@@ -0,0 +1,139 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "RigidBodyComponent.h"
+#include "Actor.h"
+#include "Game.h"
+#include "PhysWorld.h"
+#include "BoxComponent.h"
+#include "LevelLoader.h"
+
+namespace
+{
+	const char* ShapeNames[] = { "box", "sphere", "capsule" };
+}
+
+RigidBodyComponent::RigidBodyComponent(Actor* owner)
+	:Component(owner)
+	,mBox(nullptr)
+	,mVelocity(Vector3::Zero)
+	,mMass(1.0f)
+	,mInvMass(1.0f)
+	,mShape(EBox)
+	,mRadius(0.0f)
+	,mFriction(0.6f)
+	,mRestitution(0.0f)
+	,mSleepTime(0.0f)
+	,mAwakeIndex(-1)
+	,mNextAsleep(nullptr)
+{
+	// Bind to the owner's box now (so no body is ever solved as a
+	// static box). If the box comes later, it binds itself to us.
+	mBox = static_cast<BoxComponent*>(mOwner->GetComponentOfType(TBoxComponent));
+	if (mBox)
+	{
+		mBox->SetRigidBody(this);
+	}
+	mPhysHandle = mOwner->GetGame()->GetPhysWorld()->AddBody(this);
+}
+
+RigidBodyComponent::~RigidBodyComponent()
+{
+	mOwner->GetGame()->GetPhysWorld()->RemoveBody(mPhysHandle);
+	if (mBox)
+	{
+		mBox->SetRigidBody(nullptr);
+	}
+}
+
+void RigidBodyComponent::SetMass(float mass)
+{
+	mMass = mass;
+	mInvMass = mass > 0.0f ? 1.0f / mass : 0.0f;
+}
+
+void RigidBodyComponent::ApplyImpulse(const Vector3& impulse)
+{
+	mVelocity += impulse * mInvMass;
+	mSleepTime = 0.0f;
+	mOwner->GetGame()->GetPhysWorld()->WakeBody(this);
+}
+
+void RigidBodyComponent::GetSphere(Sphere& outSphere)
+{
+	const AABB& box = GetBox()->GetWorldBox();
+	outSphere.mCenter = (box.mMin + box.mMax) * 0.5f;
+	outSphere.mRadius = GetShapeRadius();
+}
+
+void RigidBodyComponent::GetCapsule(Capsule& outCapsule)
+{
+	const AABB& box = GetBox()->GetWorldBox();
+	Vector3 center = (box.mMin + box.mMax) * 0.5f;
+	float radius = GetShapeRadius();
+	float halfHeight = Math::Max(0.0f, (box.mMax.z - box.mMin.z) * 0.5f - radius);
+	outCapsule.mSegment.mStart = center - Vector3::UnitZ * halfHeight;
+	outCapsule.mSegment.mEnd = center + Vector3::UnitZ * halfHeight;
+	outCapsule.mRadius = radius;
+}
+
+float RigidBodyComponent::GetShapeRadius()
+{
+	if (mRadius > 0.0f)
+	{
+		return mRadius;
+	}
+	// The biggest that fits in the box (across for a capsule)
+	const AABB& box = GetBox()->GetWorldBox();
+	Vector3 size = box.mMax - box.mMin;
+	float radius = Math::Min(size.x, size.y);
+	if (mShape == ESphere)
+	{
+		radius = Math::Min(radius, size.z);
+	}
+	return radius * 0.5f;
+}
+
+void RigidBodyComponent::LoadProperties(const rapidjson::Value& inObj)
+{
+	Component::LoadProperties(inObj);
+
+	float mass = mMass;
+	if (JsonHelper::GetFloat(inObj, "mass", mass))
+	{
+		SetMass(mass);
+	}
+	std::string shape;
+	if (JsonHelper::GetString(inObj, "shape", shape))
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (shape == ShapeNames[i])
+			{
+				mShape = static_cast<Shape>(i);
+			}
+		}
+	}
+	JsonHelper::GetFloat(inObj, "radius", mRadius);
+	JsonHelper::GetFloat(inObj, "friction", mFriction);
+	JsonHelper::GetFloat(inObj, "restitution", mRestitution);
+	JsonHelper::GetVector3(inObj, "velocity", mVelocity);
+}
+
+void RigidBodyComponent::SaveProperties(rapidjson::Document::AllocatorType& alloc,
+	rapidjson::Value& inObj) const
+{
+	Component::SaveProperties(alloc, inObj);
+
+	JsonHelper::AddFloat(alloc, inObj, "mass", mMass);
+	JsonHelper::AddString(alloc, inObj, "shape", ShapeNames[mShape]);
+	JsonHelper::AddFloat(alloc, inObj, "radius", mRadius);
+	JsonHelper::AddFloat(alloc, inObj, "friction", mFriction);
+	JsonHelper::AddFloat(alloc, inObj, "restitution", mRestitution);
+	JsonHelper::AddVector3(alloc, inObj, "velocity", mVelocity);
+}
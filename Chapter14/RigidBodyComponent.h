@@ -0,0 +1,92 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include "Component.h"
+#include "Collision.h"
+#include "SlotMap.h"
+
+// Makes the owner a dynamic body in the physics world. The owner also
+// needs a BoxComponent, which is used for the broadphase (and as the
+// shape, unless it's a sphere or capsule that fits in the box).
+// Bodies only translate (the boxes are axis aligned), and should be on
+// actors without a parent.
+class RigidBodyComponent : public Component
+{
+public:
+	enum Shape
+	{
+		EBox,
+		ESphere,
+		// Upright, along the z axis of the box
+		ECapsule
+	};
+
+	RigidBodyComponent(class Actor* owner);
+	~RigidBodyComponent();
+
+	TypeID GetType() const override { return TRigidBodyComponent; }
+
+	void LoadProperties(const rapidjson::Value& inObj) override;
+	void SaveProperties(rapidjson::Document::AllocatorType& alloc,
+		rapidjson::Value& inObj) const override;
+
+	// The owner's box (whichever of the two was created second binds them)
+	class BoxComponent* GetBox() const { return mBox; }
+	void SetBox(class BoxComponent* box) { mBox = box; }
+
+	void SetMass(float mass);
+	float GetMass() const { return mMass; }
+	float GetInvMass() const { return mInvMass; }
+	void SetShape(Shape shape) { mShape = shape; }
+	Shape GetShape() const { return mShape; }
+	// Radius of a sphere/capsule (0 uses the biggest that fits the box)
+	void SetRadius(float radius) { mRadius = radius; }
+	float GetFriction() const { return mFriction; }
+	void SetFriction(float friction) { mFriction = friction; }
+	float GetRestitution() const { return mRestitution; }
+	void SetRestitution(float restitution) { mRestitution = restitution; }
+
+	const Vector3& GetVelocity() const { return mVelocity; }
+	void SetVelocity(const Vector3& velocity) { mVelocity = velocity; }
+	// Change in velocity from an impulse (wakes the body)
+	void ApplyImpulse(const Vector3& impulse);
+
+	// Fill in the collision shape (from the world box)
+	void GetSphere(Sphere& outSphere);
+	void GetCapsule(Capsule& outCapsule);
+
+	bool GetIsAwake() const { return mAwakeIndex >= 0; }
+	// Time spent moving slowly (to decide when to sleep)
+	float GetSleepTime() const { return mSleepTime; }
+	void SetSleepTime(float time) { mSleepTime = time; }
+
+	// Managed by PhysWorld
+	int GetAwakeIndex() const { return mAwakeIndex; }
+	void SetAwakeIndex(int index) { mAwakeIndex = index; }
+	// Next body in this body's sleeping island (a ring)
+	RigidBodyComponent* GetNextAsleep() const { return mNextAsleep; }
+	void SetNextAsleep(RigidBodyComponent* body) { mNextAsleep = body; }
+private:
+	float GetShapeRadius();
+
+	class BoxComponent* mBox;
+	Vector3 mVelocity;
+	float mMass;
+	float mInvMass;
+	Shape mShape;
+	float mRadius;
+	float mFriction;
+	float mRestitution;
+	float mSleepTime;
+	// Index in the physics world's awake bodies (-1 if asleep)
+	int mAwakeIndex;
+	RigidBodyComponent* mNextAsleep;
+	// Handle in the physics world's bodies
+	SlotHandle mPhysHandle;
+};
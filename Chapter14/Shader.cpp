@@ -50,7 +50,8 @@ bool Shader::Load(const std::string& vertName, const std::string& fragName)
 	{
 		return false;
 	}
-	
+
+	CacheUniformLocations();
 	return true;
 }
 
@@ -68,49 +69,93 @@ void Shader::SetActive()
 	glUseProgram(mShaderProgram);
 }
 
-void Shader::SetMatrixUniform(const char* name, const Matrix4& matrix)
+void Shader::SetMatrixUniform(UniformName name, const Matrix4& matrix)
 {
 	// Find the uniform by this name
-	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	GLint loc = GetUniformLocation(name);
 	// Send the matrix data to the uniform
 	glUniformMatrix4fv(loc, 1, GL_TRUE, matrix.GetAsFloatPtr());
 }
 
-void Shader::SetMatrixUniforms(const char* name, Matrix4* matrices, unsigned count)
+void Shader::SetMatrixUniforms(UniformName name, Matrix4* matrices, unsigned count)
 {
-	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	GLint loc = GetUniformLocation(name);
 	// Send the matrix data to the uniform
 	glUniformMatrix4fv(loc, count, GL_TRUE, matrices->GetAsFloatPtr());
 }
 
-void Shader::SetVectorUniform(const char* name, const Vector3& vector)
+void Shader::SetVectorUniform(UniformName name, const Vector3& vector)
 {
-	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	GLint loc = GetUniformLocation(name);
 	// Send the vector data
 	glUniform3fv(loc, 1, vector.GetAsFloatPtr());
 }
 
-void Shader::SetVector2Uniform(const char* name, const Vector2& vector)
+void Shader::SetVector2Uniform(UniformName name, const Vector2& vector)
 {
-	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	GLint loc = GetUniformLocation(name);
 	// Send the vector data
 	glUniform2fv(loc, 1, vector.GetAsFloatPtr());
 }
 
-void Shader::SetFloatUniform(const char* name, float value)
+void Shader::SetFloatUniform(UniformName name, float value)
 {
-	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	GLint loc = GetUniformLocation(name);
 	// Send the float data
 	glUniform1f(loc, value);
 }
 
-void Shader::SetIntUniform(const char* name, int value)
+void Shader::SetIntUniform(UniformName name, int value)
 {
-	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	GLint loc = GetUniformLocation(name);
 	// Send the float data
 	glUniform1i(loc, value);
 }
 
+GLint Shader::GetUniformLocation(UniformName name) const
+{
+	auto iter = mUniformLocations.find(name.mHash);
+	return iter != mUniformLocations.end() ? iter->second : -1;
+}
+
+void Shader::BindUniformBlock(const char* blockName, GLuint binding)
+{
+	GLuint index = glGetUniformBlockIndex(mShaderProgram, blockName);
+	if (index != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(mShaderProgram, index, binding);
+	}
+}
+
+void Shader::CacheUniformLocations()
+{
+	mUniformLocations.clear();
+	GLint numUniforms = 0;
+	GLint maxLength = 0;
+	glGetProgramiv(mShaderProgram, GL_ACTIVE_UNIFORMS, &numUniforms);
+	glGetProgramiv(mShaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::string name(maxLength, '\0');
+	for (GLint i = 0; i < numUniforms; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(mShaderProgram, i, maxLength, &length, &size, &type, &name[0]);
+		std::string uniform(name.c_str(), length);
+		// Arrays are listed as name[0], but set by just the name
+		if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+		{
+			uniform.resize(uniform.size() - 3);
+		}
+		// (uniforms in a block have no location)
+		GLint loc = glGetUniformLocation(mShaderProgram, uniform.c_str());
+		if (loc >= 0)
+		{
+			mUniformLocations.emplace(HashUniformName(uniform.c_str()), loc);
+		}
+	}
+}
+
 bool Shader::CompileShader(const std::string& fileName,
 				   GLenum shaderType,
 				   GLuint& outShader)
@@ -9,8 +9,32 @@
 #pragma once
 #include <GL/glew.h>
 #include <string>
+#include <unordered_map>
+#include <cstdint>
 #include "Math.h"
 
+// FNV-1a hash of a uniform's name (constexpr, so a literal's hash can
+// be computed at compile time)
+constexpr uint32_t HashUniformName(const char* name, uint32_t hash = 2166136261u)
+{
+	return *name ? HashUniformName(name + 1,
+		(hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+}
+
+// A uniform, named by its hash. Shaders look these up in the uniform
+// locations they found when they linked (instead of asking GL by
+// string each time). For hot code, make it a constant, like
+// const UniformName WorldTransformName("uWorldTransform");
+struct UniformName
+{
+	constexpr UniformName(const char* name)
+		:mHash(HashUniformName(name))
+	{
+	}
+
+	uint32_t mHash;
+};
+
 class Shader
 {
 public:
@@ -20,18 +44,25 @@ public:
 	void Unload();
 	// Set this as the active shader program
 	void SetActive();
+	GLuint GetProgramID() const { return mShaderProgram; }
 	// Sets a Matrix uniform
-	void SetMatrixUniform(const char* name, const Matrix4& matrix);
+	void SetMatrixUniform(UniformName name, const Matrix4& matrix);
 	// Sets an array of matrix uniforms
-	void SetMatrixUniforms(const char* name, Matrix4* matrices, unsigned count);
+	void SetMatrixUniforms(UniformName name, Matrix4* matrices, unsigned count);
 	// Sets a Vector3 uniform
-	void SetVectorUniform(const char* name, const Vector3& vector);
-	void SetVector2Uniform(const char* name, const Vector2& vector);
+	void SetVectorUniform(UniformName name, const Vector3& vector);
+	void SetVector2Uniform(UniformName name, const Vector2& vector);
 	// Sets a float uniform
-	void SetFloatUniform(const char* name, float value);
+	void SetFloatUniform(UniformName name, float value);
 	// Sets an integer uniform
-	void SetIntUniform(const char* name, int value);
+	void SetIntUniform(UniformName name, int value);
+	// Location of the uniform (-1 if the program doesn't use it)
+	GLint GetUniformLocation(UniformName name) const;
+	// Read the uniform block (if the program has it) from this binding
+	void BindUniformBlock(const char* blockName, GLuint binding);
 private:
+	// Find every active uniform's location (after linking)
+	void CacheUniformLocations();
 	// Tries to compile the specified shader
 	bool CompileShader(const std::string& fileName,
 					   GLenum shaderType,
@@ -46,4 +77,6 @@ private:
 	GLuint mVertexShader;
 	GLuint mFragShader;
 	GLuint mShaderProgram;
+	// Uniform locations, by name hash
+	std::unordered_map<uint32_t, GLint> mUniformLocations;
 };
@@ -34,16 +34,19 @@ struct DirectionalLight
 	vec3 mSpecColor;
 };
 
-// Uniforms for lighting
-// Camera position (in world space)
-uniform vec3 uCameraPos;
+// Uniforms for lighting, shared by every shader (in a uniform buffer)
+layout(std140) uniform LightBlock
+{
+	// Camera position (in world space)
+	vec3 uCameraPos;
+	// Ambient light level
+	vec3 uAmbientLight;
+	// Directional Light
+	DirectionalLight uDirLight;
+};
+
 // Specular power for this surface
 uniform float uSpecPower;
-// Ambient light level
-uniform vec3 uAmbientLight;
-
-// Directional Light
-uniform DirectionalLight uDirLight;
 
 void main()
 {
@@ -9,9 +9,13 @@
 // Request GLSL 3.3
 #version 330
 
-// Uniforms for world transform and view-proj
+// Uniform for world transform
 uniform mat4 uWorldTransform;
-uniform mat4 uViewProj;
+// Per-view uniforms, shared by every shader (in a uniform buffer)
+layout(std140, row_major) uniform ViewBlock
+{
+	mat4 uViewProj;
+};
 
 // Attribute 0 is position, 1 is normal, 2 is tex coords.
 layout(location = 0) in vec3 inPosition;
@@ -0,0 +1,56 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+// Request GLSL 3.3
+#version 330
+
+// Per-view uniforms, shared by every shader (in a uniform buffer)
+layout(std140, row_major) uniform ViewBlock
+{
+	mat4 uViewProj;
+};
+
+// Attribute 0 is position, 1 is normal, 2 is tex coords.
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+// Attributes 3-6 are the rows of this instance's world transform
+layout(location = 3) in vec4 inWorldRow0;
+layout(location = 4) in vec4 inWorldRow1;
+layout(location = 5) in vec4 inWorldRow2;
+layout(location = 6) in vec4 inWorldRow3;
+
+// Any vertex outputs (other than position)
+out vec2 fragTexCoord;
+// Normal (in world space)
+out vec3 fragNormal;
+// Position (in world space)
+out vec3 fragWorldPos;
+
+void main()
+{
+	// Rebuild the world transform (the constructor takes columns,
+	// so transpose it to get rows)
+	mat4 worldTransform = transpose(mat4(inWorldRow0, inWorldRow1,
+		inWorldRow2, inWorldRow3));
+
+	// Convert position to homogeneous coordinates
+	vec4 pos = vec4(inPosition, 1.0);
+	// Transform position to world space
+	pos = pos * worldTransform;
+	// Save world position
+	fragWorldPos = pos.xyz;
+	// Transform to clip space
+	gl_Position = pos * uViewProj;
+
+	// Transform normal into world space (w = 0)
+	fragNormal = (vec4(inNormal, 0.0f) * worldTransform).xyz;
+
+	// Pass along the texture coordinate to frag shader
+	fragTexCoord = inTexCoord;
+}
@@ -9,8 +9,9 @@
 // Request GLSL 3.3
 #version 330
 
-// Tex coord input from vertex shader
+// Tex coord and color input from vertex shader
 in vec2 fragTexCoord;
+in vec4 fragColor;
 
 // This corresponds to the output color to the color buffer
 out vec4 outColor;
@@ -20,6 +21,6 @@ uniform sampler2D uTexture;
 
 void main()
 {
-	// Sample color from texture
-    outColor = texture(uTexture, fragTexCoord);
+	// Sample color from texture, tinted by the sprite's color
+    outColor = texture(uTexture, fragTexCoord) * fragColor;
 }
@@ -18,36 +18,23 @@
 #include "Skeleton.h"
 #include "LevelLoader.h"
 
+namespace
+{
+	const UniformName MatrixPaletteName("uMatrixPalette");
+}
+
 SkeletalMeshComponent::SkeletalMeshComponent(Actor* owner)
 	:MeshComponent(owner, true)
 	,mSkeleton(nullptr)
 {
 }
 
-void SkeletalMeshComponent::Draw(Shader* shader)
+void SkeletalMeshComponent::SetDrawUniforms(Shader* shader)
 {
-	if (mMesh)
-	{
-		// Set the world transform
-		shader->SetMatrixUniform("uWorldTransform", 
-			mOwner->GetWorldTransform());
-		// Set the matrix palette
-		shader->SetMatrixUniforms("uMatrixPalette", &mPalette.mEntry[0], 
-			MAX_SKELETON_BONES);
-		// Set specular power
-		shader->SetFloatUniform("uSpecPower", mMesh->GetSpecPower());
-		// Set the active texture
-		Texture* t = mMesh->GetTexture(mTextureIndex);
-		if (t)
-		{
-			t->SetActive();
-		}
-		// Set the mesh's vertex array as active
-		VertexArray* va = mMesh->GetVertexArray();
-		va->SetActive();
-		// Draw
-		glDrawElements(GL_TRIANGLES, va->GetNumIndices(), GL_UNSIGNED_INT, nullptr);
-	}
+	MeshComponent::SetDrawUniforms(shader);
+	// Set the matrix palette
+	shader->SetMatrixUniforms(MatrixPaletteName, &mPalette.mEntry[0], 
+		MAX_SKELETON_BONES);
 }
 
 void SkeletalMeshComponent::Update(float deltaTime)
@@ -14,10 +14,12 @@ class SkeletalMeshComponent : public MeshComponent
 {
 public:
 	SkeletalMeshComponent(class Actor* owner);
-	// Draw this mesh component
-	void Draw(class Shader* shader) override;
+	// Also sets the matrix palette
+	void SetDrawUniforms(class Shader* shader) override;
 
 	void Update(float deltaTime) override;
+	// Computing the palette only reads the (shared) skeleton/animation
+	bool GetIsThreadSafe() const override { return true; }
 
 	// Setters
 	void SetSkeleton(class Skeleton* sk) { mSkeleton = sk; }
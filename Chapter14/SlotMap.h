@@ -0,0 +1,222 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Refers to an element of a SlotMap. The generation changes every
+// time a slot is reused, so a handle to something that was removed
+// never finds whatever took its place.
+struct SlotHandle
+{
+	uint32_t mIndex = 0;
+	// Generation 0 is never used, so a default handle is null
+	uint32_t mGeneration = 0;
+
+	bool IsNull() const { return mGeneration == 0; }
+	bool operator==(const SlotHandle& other) const
+	{
+		return mIndex == other.mIndex && mGeneration == other.mGeneration;
+	}
+	bool operator!=(const SlotHandle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+// Stores elements densely (for fast iteration), with O(1) insert,
+// remove, and lookup by handle. Removing swaps the last element into
+// the hole, so the dense order isn't stable unless Sort is called
+// (or the removal is part of a batch).
+template <typename T>
+class SlotMap
+{
+public:
+	SlotHandle Insert(const T& value)
+	{
+		uint32_t slotIndex;
+		if (!mFreeSlots.empty())
+		{
+			slotIndex = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<uint32_t>(mSlots.size());
+			mSlots.emplace_back();
+		}
+
+		Slot& slot = mSlots[slotIndex];
+		slot.mDenseIndex = static_cast<uint32_t>(mDense.size());
+		mDense.emplace_back(value);
+		mDenseToSlot.emplace_back(slotIndex);
+
+		SlotHandle handle;
+		handle.mIndex = slotIndex;
+		handle.mGeneration = slot.mGeneration;
+		return handle;
+	}
+
+	// Returns false if the handle was already stale
+	bool Remove(SlotHandle handle)
+	{
+		if (!IsValid(handle))
+		{
+			return false;
+		}
+
+		Slot& slot = mSlots[handle.mIndex];
+		uint32_t denseIndex = slot.mDenseIndex;
+		if (mBatchRemoving)
+		{
+			// Leave a hole for EndBatchRemove to close
+			mDenseToSlot[denseIndex] = HoleSlot;
+			mNumHoles++;
+		}
+		else
+		{
+			uint32_t lastIndex = static_cast<uint32_t>(mDense.size()) - 1;
+			if (denseIndex != lastIndex)
+			{
+				// Move the last element into the hole
+				mDense[denseIndex] = mDense[lastIndex];
+				mDenseToSlot[denseIndex] = mDenseToSlot[lastIndex];
+				mSlots[mDenseToSlot[denseIndex]].mDenseIndex = denseIndex;
+			}
+			mDense.pop_back();
+			mDenseToSlot.pop_back();
+		}
+
+		// Bump the generation so old handles go stale
+		slot.mGeneration++;
+		if (slot.mGeneration == 0)
+		{
+			slot.mGeneration = 1;
+		}
+		mFreeSlots.emplace_back(handle.mIndex);
+		return true;
+	}
+
+	bool IsValid(SlotHandle handle) const
+	{
+		return !handle.IsNull() && handle.mIndex < mSlots.size() &&
+			mSlots[handle.mIndex].mGeneration == handle.mGeneration;
+	}
+
+	// Returns nullptr if the handle is stale
+	T* Get(SlotHandle handle)
+	{
+		return IsValid(handle) ? &mDense[mSlots[handle.mIndex].mDenseIndex] : nullptr;
+	}
+	const T* Get(SlotHandle handle) const
+	{
+		return IsValid(handle) ? &mDense[mSlots[handle.mIndex].mDenseIndex] : nullptr;
+	}
+
+	// Sort the dense elements (handles stay valid)
+	template <typename Compare>
+	void Sort(Compare comp)
+	{
+		// Sort (dense index) permutation, then apply it
+		std::vector<uint32_t> order(mDense.size());
+		for (uint32_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[this, &comp](uint32_t a, uint32_t b) {
+				return comp(mDense[a], mDense[b]);
+			});
+
+		std::vector<T> dense;
+		std::vector<uint32_t> denseToSlot;
+		dense.reserve(mDense.size());
+		denseToSlot.reserve(mDense.size());
+		for (uint32_t i : order)
+		{
+			mSlots[mDenseToSlot[i]].mDenseIndex = static_cast<uint32_t>(dense.size());
+			dense.emplace_back(mDense[i]);
+			denseToSlot.emplace_back(mDenseToSlot[i]);
+		}
+		mDense.swap(dense);
+		mDenseToSlot.swap(denseToSlot);
+	}
+
+	// Between these, a removal only leaves a hole, and EndBatchRemove
+	// closes all of them in one pass (keeping the order of the rest).
+	// Don't iterate in between, because the holes are still there.
+	void BeginBatchRemove() { mBatchRemoving = true; }
+	void EndBatchRemove()
+	{
+		mBatchRemoving = false;
+		if (mNumHoles == 0)
+		{
+			return;
+		}
+
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < mDense.size(); i++)
+		{
+			if (mDenseToSlot[i] != HoleSlot)
+			{
+				mDense[count] = mDense[i];
+				mDenseToSlot[count] = mDenseToSlot[i];
+				mSlots[mDenseToSlot[count]].mDenseIndex = count;
+				count++;
+			}
+		}
+		mDense.erase(mDense.begin() + count, mDense.end());
+		mDenseToSlot.erase(mDenseToSlot.begin() + count, mDenseToSlot.end());
+		mNumHoles = 0;
+	}
+	bool GetIsBatchRemoving() const { return mBatchRemoving; }
+
+	void Clear()
+	{
+		// Remove everything, so outstanding handles go stale
+		while (!mDense.empty())
+		{
+			SlotHandle handle;
+			handle.mIndex = mDenseToSlot.back();
+			handle.mGeneration = mSlots[handle.mIndex].mGeneration;
+			Remove(handle);
+		}
+	}
+
+	// Dense access/iteration
+	size_t Size() const { return mDense.size(); }
+	bool Empty() const { return mDense.empty(); }
+	T& operator[](size_t i) { return mDense[i]; }
+	const T& operator[](size_t i) const { return mDense[i]; }
+	T& Back() { return mDense.back(); }
+	const std::vector<T>& GetDense() const { return mDense; }
+	typename std::vector<T>::iterator begin() { return mDense.begin(); }
+	typename std::vector<T>::iterator end() { return mDense.end(); }
+	typename std::vector<T>::const_iterator begin() const { return mDense.begin(); }
+	typename std::vector<T>::const_iterator end() const { return mDense.end(); }
+private:
+	struct Slot
+	{
+		uint32_t mDenseIndex = 0;
+		uint32_t mGeneration = 1;
+	};
+	// Elements, packed together
+	std::vector<T> mDense;
+	// Slot each dense element belongs to
+	std::vector<uint32_t> mDenseToSlot;
+	// Where each handle's element lives in mDense
+	std::vector<Slot> mSlots;
+	// Slots available for reuse
+	std::vector<uint32_t> mFreeSlots;
+	// Marks a dense element removed during a batch
+	static const uint32_t HoleSlot = 0xFFFFFFFF;
+	bool mBatchRemoving = false;
+	uint32_t mNumHoles = 0;
+};
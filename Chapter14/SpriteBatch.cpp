@@ -0,0 +1,176 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "SpriteBatch.h"
+#include "Texture.h"
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	// Quads per flush (more than this in a frame just flushes early)
+	const size_t MaxSprites = 2048;
+	const size_t VertsPerSprite = 4;
+	const size_t IndicesPerSprite = 6;
+
+	uint8_t ToByte(float value)
+	{
+		return static_cast<uint8_t>(Math::Clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+SpriteBatch::SpriteBatch()
+	:mVertexArray(0)
+	,mVertexBuffer(0)
+	,mIndexBuffer(0)
+{
+	ResetStats();
+}
+
+void SpriteBatch::Initialize()
+{
+	glGenVertexArrays(1, &mVertexArray);
+	glBindVertexArray(mVertexArray);
+
+	// The vertices are rewritten every flush
+	glGenBuffers(1, &mVertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, MaxSprites * VertsPerSprite * sizeof(Vertex),
+		nullptr, GL_STREAM_DRAW);
+
+	// Every quad is two triangles, the same as the sprite quad
+	std::vector<unsigned int> indices;
+	indices.reserve(MaxSprites * IndicesPerSprite);
+	for (size_t i = 0; i < MaxSprites; i++)
+	{
+		unsigned int first = static_cast<unsigned int>(i * VertsPerSprite);
+		indices.emplace_back(first);
+		indices.emplace_back(first + 1);
+		indices.emplace_back(first + 2);
+		indices.emplace_back(first + 2);
+		indices.emplace_back(first + 3);
+		indices.emplace_back(first);
+	}
+	glGenBuffers(1, &mIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
+		indices.data(), GL_STATIC_DRAW);
+
+	// Position is 2 floats
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+		reinterpret_cast<void*>(offsetof(Vertex, mPos)));
+	// Texture coordinates is 2 floats
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+		reinterpret_cast<void*>(offsetof(Vertex, mTexCoord)));
+	// Color is 4 bytes
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+		reinterpret_cast<void*>(offsetof(Vertex, mColor)));
+
+	mVerts.reserve(MaxSprites * VertsPerSprite);
+}
+
+void SpriteBatch::Shutdown()
+{
+	glDeleteBuffers(1, &mVertexBuffer);
+	glDeleteBuffers(1, &mIndexBuffer);
+	glDeleteVertexArrays(1, &mVertexArray);
+	mVertexBuffer = 0;
+	mIndexBuffer = 0;
+	mVertexArray = 0;
+}
+
+void SpriteBatch::Draw(Texture* texture, const Matrix4& world,
+	const Vector3& color, float alpha, const Vector2& uvMin, const Vector2& uvMax)
+{
+	if (mVerts.size() == MaxSprites * VertsPerSprite)
+	{
+		Flush();
+	}
+
+	// Start a new batch if the texture changed
+	size_t sprite = mVerts.size() / VertsPerSprite;
+	if (mBatches.empty() || mBatches.back().mTexture != texture)
+	{
+		mBatches.emplace_back(Batch{ texture, sprite, 0 });
+	}
+	mBatches.back().mCount++;
+
+	// Corners of the unit quad are center +/- half of the x and y axes
+	// (rows of the world transform)
+	Vector2 center(world.mat[3][0], world.mat[3][1]);
+	Vector2 halfX(world.mat[0][0] * 0.5f, world.mat[0][1] * 0.5f);
+	Vector2 halfY(world.mat[1][0] * 0.5f, world.mat[1][1] * 0.5f);
+	Vector2 corners[VertsPerSprite] = {
+		center - halfX + halfY, // top left
+		center + halfX + halfY, // top right
+		center + halfX - halfY, // bottom right
+		center - halfX - halfY  // bottom left
+	};
+	Vector2 texCoords[VertsPerSprite] = {
+		uvMin,
+		Vector2(uvMax.x, uvMin.y),
+		uvMax,
+		Vector2(uvMin.x, uvMax.y)
+	};
+
+	Vertex v;
+	v.mColor[0] = ToByte(color.x);
+	v.mColor[1] = ToByte(color.y);
+	v.mColor[2] = ToByte(color.z);
+	v.mColor[3] = ToByte(alpha);
+	for (size_t i = 0; i < VertsPerSprite; i++)
+	{
+		v.mPos[0] = corners[i].x;
+		v.mPos[1] = corners[i].y;
+		v.mTexCoord[0] = texCoords[i].x;
+		v.mTexCoord[1] = texCoords[i].y;
+		mVerts.emplace_back(v);
+	}
+}
+
+void SpriteBatch::Flush()
+{
+	if (mVerts.empty())
+	{
+		return;
+	}
+
+	// Orphan the old vertices (so the driver doesn't wait on draws that
+	// still read them), then upload the new ones
+	glBindVertexArray(mVertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, MaxSprites * VertsPerSprite * sizeof(Vertex),
+		nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, mVerts.size() * sizeof(Vertex), mVerts.data());
+
+	for (const Batch& b : mBatches)
+	{
+		if (b.mTexture)
+		{
+			b.mTexture->SetActive();
+		}
+		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(b.mCount * IndicesPerSprite),
+			GL_UNSIGNED_INT,
+			reinterpret_cast<void*>(b.mStart * IndicesPerSprite * sizeof(unsigned int)));
+		mStats.mDrawCalls++;
+	}
+	mStats.mSprites += static_cast<uint32_t>(mVerts.size() / VertsPerSprite);
+	mStats.mFlushes++;
+
+	mVerts.clear();
+	mBatches.clear();
+}
+
+void SpriteBatch::ResetStats()
+{
+	memset(&mStats, 0, sizeof(mStats));
+}
@@ -0,0 +1,69 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Math.h"
+
+// Collects 2D quads (already transformed to screen space, with a UV
+// rect and a color) into one streaming vertex buffer. Quads in a row
+// with the same texture become one draw call, and the order they were
+// added in is kept (so draw order/alpha blending still work).
+class SpriteBatch
+{
+public:
+	// GL calls made by Flush (added up until Reset)
+	struct Stats
+	{
+		uint32_t mDrawCalls;
+		uint32_t mSprites;
+		uint32_t mFlushes;
+	};
+
+	SpriteBatch();
+
+	// Create/destroy the vertex array and buffers (needs a GL context)
+	void Initialize();
+	void Shutdown();
+
+	// Add the unit quad (centered on the origin), transformed by world.
+	// uvMin/uvMax pick the part of the texture to show.
+	void Draw(class Texture* texture, const Matrix4& world,
+		const Vector3& color = Color::White, float alpha = 1.0f,
+		const Vector2& uvMin = Vector2::Zero,
+		const Vector2& uvMax = Vector2(1.0f, 1.0f));
+	// Draw everything added so far (the sprite shader must be active)
+	void Flush();
+
+	const Stats& GetStats() const { return mStats; }
+	void ResetStats();
+private:
+	struct Vertex
+	{
+		float mPos[2];
+		float mTexCoord[2];
+		// RGBA, normalized in the shader
+		uint8_t mColor[4];
+	};
+
+	struct Batch
+	{
+		class Texture* mTexture;
+		// Quads [mStart, mStart + mCount) use this texture
+		size_t mStart;
+		size_t mCount;
+	};
+
+	std::vector<Vertex> mVerts;
+	std::vector<Batch> mBatches;
+	unsigned int mVertexArray;
+	unsigned int mVertexBuffer;
+	unsigned int mIndexBuffer;
+	Stats mStats;
+};
@@ -8,7 +8,7 @@
 
 #include "SpriteComponent.h"
 #include "Texture.h"
-#include "Shader.h"
+#include "SpriteBatch.h"
 #include "Actor.h"
 #include "Game.h"
 #include "Renderer.h"
@@ -22,15 +22,15 @@ SpriteComponent::SpriteComponent(Actor* owner, int drawOrder)
 	,mTexHeight(0)
 	,mVisible(true)
 {
-	mOwner->GetGame()->GetRenderer()->AddSprite(this);
+	mRenderHandle = mOwner->GetGame()->GetRenderer()->AddSprite(this);
 }
 
 SpriteComponent::~SpriteComponent()
 {
-	mOwner->GetGame()->GetRenderer()->RemoveSprite(this);
+	mOwner->GetGame()->GetRenderer()->RemoveSprite(mRenderHandle);
 }
 
-void SpriteComponent::Draw(Shader* shader)
+void SpriteComponent::Draw(SpriteBatch* batch)
 {
 	if (mTexture)
 	{
@@ -40,17 +40,11 @@ void SpriteComponent::Draw(Shader* shader)
 			static_cast<float>(mTexHeight),
 			1.0f);
 		
-		Matrix4 world = scaleMat * mOwner->GetWorldTransform();
-		
-		// Since all sprites use the same shader/vertices,
-		// the game first sets them active before any sprite draws
-		
-		// Set world transform
-		shader->SetMatrixUniform("uWorldTransform", world);
-		// Set current texture
-		mTexture->SetActive();
-		// Draw quad
-		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+		Matrix4 world = scaleMat * mOwner->GetRenderTransform();
+
+		// The renderer draws the batch once every sprite and UI
+		// screen has added to it
+		batch->Draw(mTexture, world);
 	}
 }
 
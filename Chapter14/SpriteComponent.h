@@ -8,6 +8,7 @@
 
 #pragma once
 #include "Component.h"
+#include "SlotMap.h"
 #include "SDL/SDL.h"
 
 class SpriteComponent : public Component
@@ -17,7 +18,8 @@ public:
 	SpriteComponent(class Actor* owner, int drawOrder = 100);
 	~SpriteComponent();
 
-	virtual void Draw(class Shader* shader);
+	// Adds the sprite's quad to the batch
+	virtual void Draw(class SpriteBatch* batch);
 	virtual void SetTexture(class Texture* texture);
 
 	int GetDrawOrder() const { return mDrawOrder; }
@@ -38,4 +40,6 @@ protected:
 	int mTexWidth;
 	int mTexHeight;
 	bool mVisible;
+	// Handle in the renderer's sprites
+	SlotHandle mRenderHandle;
 };
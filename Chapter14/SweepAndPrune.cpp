@@ -0,0 +1,465 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+namespace
+{
+	float GetAxis(const Vector3& v, int axis)
+	{
+		return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+	}
+}
+
+SweepAndPrune::SweepAndPrune()
+	:mHasDead(false)
+{
+}
+
+int SweepAndPrune::CreateProxy(const AABB& box, void* userData)
+{
+	int id;
+	if (!mFreeProxies.empty())
+	{
+		id = mFreeProxies.back();
+		mFreeProxies.pop_back();
+	}
+	else
+	{
+		id = static_cast<int>(mProxies.size());
+		mProxies.emplace_back();
+	}
+
+	Proxy& proxy = mProxies[id];
+	proxy.mUserData = userData;
+	proxy.mAlive = true;
+	proxy.mMin[0] = 0;
+
+	// Wait to be added to the arrays with the other new ones
+	proxy.mPending = static_cast<int>(mPending.size());
+	mPending.emplace_back(PendingProxy{ id, box });
+	return id;
+}
+
+void SweepAndPrune::DestroyProxy(int proxyID)
+{
+	if (mProxies[proxyID].mPending >= 0)
+	{
+		// Never made it into the arrays
+		RemovePending(proxyID);
+	}
+	// Its endpoints stay (skipped, and never paired again) until the
+	// pairs are next needed
+	mProxies[proxyID].mAlive = false;
+	mProxies[proxyID].mUserData = nullptr;
+	mHasDead = true;
+}
+
+void SweepAndPrune::UpdateProxy(int proxyID, const AABB& box)
+{
+	if (mProxies[proxyID].mPending >= 0)
+	{
+		mPending[mProxies[proxyID].mPending].mBox = box;
+		return;
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		std::vector<Endpoint>& endpoints = mAxes[axis];
+		uint32_t minIndex = mProxies[proxyID].mMin[axis];
+		uint32_t maxIndex = mProxies[proxyID].mMax[axis];
+		float oldMin = endpoints[minIndex].mValue;
+		float oldMax = endpoints[maxIndex].mValue;
+		float newMin = GetAxis(box.mMin, axis);
+		float newMax = GetAxis(box.mMax, axis);
+		endpoints[minIndex].mValue = newMin;
+		endpoints[maxIndex].mValue = newMax;
+
+		// Grow first, then shrink, so the min never passes the max
+		if (newMin < oldMin)
+		{
+			SortDown(axis, mProxies[proxyID].mMin[axis]);
+		}
+		if (newMax > oldMax)
+		{
+			SortUp(axis, mProxies[proxyID].mMax[axis]);
+		}
+		if (newMin > oldMin)
+		{
+			SortUp(axis, mProxies[proxyID].mMin[axis]);
+		}
+		if (newMax < oldMax)
+		{
+			SortDown(axis, mProxies[proxyID].mMax[axis]);
+		}
+	}
+}
+
+void SweepAndPrune::ForEachPair(const std::function<void(void*, void*)>& f)
+{
+	ApplyChanges();
+	for (const auto& iter : mPairs)
+	{
+		f(mProxies[iter.second.mProxyA].mUserData,
+			mProxies[iter.second.mProxyB].mUserData);
+	}
+}
+
+void SweepAndPrune::ReportPairs(const std::function<void(PairEvent, void*, void*)>& f)
+{
+	ApplyChanges();
+	for (auto& iter : mPairs)
+	{
+		Pair& pair = iter.second;
+		f(pair.mIsNew ? EBegin : EPersist, mProxies[pair.mProxyA].mUserData,
+			mProxies[pair.mProxyB].mUserData);
+		pair.mIsNew = false;
+	}
+
+	for (auto& ended : mEnded)
+	{
+		f(EEnd, mProxies[ended.first].mUserData, mProxies[ended.second].mUserData);
+	}
+	mEnded.clear();
+}
+
+void SweepAndPrune::SortDown(int axis, uint32_t index)
+{
+	std::vector<Endpoint>& endpoints = mAxes[axis];
+	Endpoint e = endpoints[index];
+	int proxy = e.GetProxy();
+	while (index > 0 && endpoints[index - 1].mValue > e.mValue)
+	{
+		const Endpoint& prev = endpoints[index - 1];
+		int other = prev.GetProxy();
+		if (other != proxy)
+		{
+			if (!e.IsMax() && prev.IsMax())
+			{
+				// Our min passed their max, so we now overlap on this axis
+				if (OverlapsOtherAxes(axis, proxy, other))
+				{
+					AddPair(proxy, other);
+				}
+			}
+			else if (e.IsMax() && !prev.IsMax())
+			{
+				// Our max passed their min, so we no longer overlap
+				RemovePair(proxy, other);
+			}
+		}
+
+		// Shift the other endpoint up one
+		endpoints[index] = prev;
+		SetEndpointIndex(endpoints[index], axis, index);
+		index--;
+	}
+	endpoints[index] = e;
+	SetEndpointIndex(e, axis, index);
+}
+
+void SweepAndPrune::SortUp(int axis, uint32_t index)
+{
+	std::vector<Endpoint>& endpoints = mAxes[axis];
+	Endpoint e = endpoints[index];
+	int proxy = e.GetProxy();
+	uint32_t last = static_cast<uint32_t>(endpoints.size()) - 1;
+	while (index < last && endpoints[index + 1].mValue < e.mValue)
+	{
+		const Endpoint& next = endpoints[index + 1];
+		int other = next.GetProxy();
+		if (other != proxy)
+		{
+			if (e.IsMax() && !next.IsMax())
+			{
+				// Our max passed their min, so we now overlap on this axis
+				if (OverlapsOtherAxes(axis, proxy, other))
+				{
+					AddPair(proxy, other);
+				}
+			}
+			else if (!e.IsMax() && next.IsMax())
+			{
+				// Our min passed their max, so we no longer overlap
+				RemovePair(proxy, other);
+			}
+		}
+
+		// Shift the other endpoint down one
+		endpoints[index] = next;
+		SetEndpointIndex(endpoints[index], axis, index);
+		index++;
+	}
+	endpoints[index] = e;
+	SetEndpointIndex(e, axis, index);
+}
+
+void SweepAndPrune::SetEndpointIndex(const Endpoint& e, int axis, uint32_t index)
+{
+	Proxy& proxy = mProxies[e.GetProxy()];
+	if (e.IsMax())
+	{
+		proxy.mMax[axis] = index;
+	}
+	else
+	{
+		proxy.mMin[axis] = index;
+	}
+}
+
+bool SweepAndPrune::OverlapsOtherAxes(int axis, int a, int b) const
+{
+	const Proxy& pa = mProxies[a];
+	const Proxy& pb = mProxies[b];
+	if (!pa.mAlive || !pb.mAlive)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (i != axis &&
+			(pa.mMax[i] < pb.mMin[i] || pb.mMax[i] < pa.mMin[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void SweepAndPrune::AddPair(int a, int b)
+{
+	uint64_t key = PairKey(a, b);
+	if (mPairs.find(key) != mPairs.end())
+	{
+		return;
+	}
+
+	// If it ended and began again since the last report, it persisted
+	bool isNew = true;
+	for (auto iter = mEnded.begin(); iter != mEnded.end(); ++iter)
+	{
+		if (PairKey(iter->first, iter->second) == key)
+		{
+			mEnded.erase(iter);
+			isNew = false;
+			break;
+		}
+	}
+	mPairs.emplace(key, Pair{ Math::Min(a, b), Math::Max(a, b), isNew });
+}
+
+void SweepAndPrune::RemovePair(int a, int b)
+{
+	auto iter = mPairs.find(PairKey(a, b));
+	if (iter == mPairs.end())
+	{
+		return;
+	}
+
+	// A pair that was never reported can just go away
+	if (!iter->second.mIsNew)
+	{
+		mEnded.emplace_back(iter->second.mProxyA, iter->second.mProxyB);
+	}
+	mPairs.erase(iter);
+}
+
+void SweepAndPrune::Compact()
+{
+	mHasDead = false;
+
+	// Slide the live endpoints down over the dead ones
+	for (int axis = 0; axis < 3; axis++)
+	{
+		std::vector<Endpoint>& endpoints = mAxes[axis];
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < endpoints.size(); i++)
+		{
+			if (mProxies[endpoints[i].GetProxy()].mAlive)
+			{
+				endpoints[count] = endpoints[i];
+				SetEndpointIndex(endpoints[count], axis, count);
+				count++;
+			}
+		}
+		endpoints.erase(endpoints.begin() + count, endpoints.end());
+	}
+
+	// Drop pairs with a dead proxy
+	for (auto iter = mPairs.begin(); iter != mPairs.end();)
+	{
+		if (!mProxies[iter->second.mProxyA].mAlive ||
+			!mProxies[iter->second.mProxyB].mAlive)
+		{
+			iter = mPairs.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+	mEnded.erase(std::remove_if(mEnded.begin(), mEnded.end(),
+		[this](const std::pair<int, int>& p) {
+			return !mProxies[p.first].mAlive || !mProxies[p.second].mAlive;
+		}), mEnded.end());
+
+	// Now the dead IDs can be reused
+	for (size_t i = 0; i < mProxies.size(); i++)
+	{
+		Proxy& proxy = mProxies[i];
+		if (!proxy.mAlive && proxy.mMin[0] != UINT32_MAX)
+		{
+			proxy.mMin[0] = UINT32_MAX;
+			mFreeProxies.emplace_back(static_cast<int>(i));
+		}
+	}
+}
+
+size_t SweepAndPrune::GetNumPairs()
+{
+	ApplyChanges();
+	return mPairs.size();
+}
+
+size_t SweepAndPrune::GetMemoryUsage() const
+{
+	size_t bytes = mProxies.capacity() * sizeof(Proxy) +
+		mFreeProxies.capacity() * sizeof(int) +
+		mPending.capacity() * sizeof(PendingProxy) +
+		(mActive.capacity() + mActiveNew.capacity() + mActiveIndex.capacity() +
+		mActiveNewIndex.capacity()) * sizeof(int);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		bytes += mAxes[axis].capacity() * sizeof(Endpoint);
+	}
+	// (roughly: a node per pair, plus the bucket array)
+	bytes += mPairs.size() * (sizeof(uint64_t) + sizeof(Pair) + sizeof(void*)) +
+		mPairs.bucket_count() * sizeof(void*);
+	return bytes;
+}
+
+void SweepAndPrune::InsertPending()
+{
+	if (mPending.empty())
+	{
+		return;
+	}
+
+	// Sort the new endpoints, and merge them into each axis
+	for (int axis = 0; axis < 3; axis++)
+	{
+		std::vector<Endpoint>& endpoints = mAxes[axis];
+		size_t oldSize = endpoints.size();
+		for (const PendingProxy& pending : mPending)
+		{
+			uint32_t id = static_cast<uint32_t>(pending.mProxy) << 1;
+			endpoints.emplace_back(Endpoint{ GetAxis(pending.mBox.mMin, axis), id });
+			endpoints.emplace_back(Endpoint{ GetAxis(pending.mBox.mMax, axis), id | 1 });
+		}
+		// (a flat box's min goes before its max)
+		std::sort(endpoints.begin() + oldSize, endpoints.end(),
+			[](const Endpoint& a, const Endpoint& b) {
+				return a.mValue < b.mValue ||
+					(a.mValue == b.mValue && !a.IsMax() && b.IsMax());
+		});
+		std::inplace_merge(endpoints.begin(), endpoints.begin() + oldSize, endpoints.end(),
+			[](const Endpoint& a, const Endpoint& b) {
+				return a.mValue < b.mValue;
+		});
+		for (uint32_t i = 0; i < endpoints.size(); i++)
+		{
+			SetEndpointIndex(endpoints[i], axis, i);
+		}
+	}
+
+	// Sweep along x. At each min endpoint, the boxes still open overlap
+	// it on x, so those are the only ones to check. Each new pair is
+	// found at the later of the two mins, and old pairs are skipped.
+	mActive.clear();
+	mActiveNew.clear();
+	mActiveIndex.resize(mProxies.size());
+	mActiveNewIndex.resize(mProxies.size());
+	for (const Endpoint& e : mAxes[0])
+	{
+		int proxy = e.GetProxy();
+		if (!mProxies[proxy].mAlive)
+		{
+			continue;
+		}
+
+		bool isNew = mProxies[proxy].mPending >= 0;
+		if (!e.IsMax())
+		{
+			const std::vector<int>& others = isNew ? mActive : mActiveNew;
+			for (int other : others)
+			{
+				if (OverlapsOtherAxes(0, proxy, other))
+				{
+					AddPair(proxy, other);
+				}
+			}
+
+			mActiveIndex[proxy] = static_cast<int>(mActive.size());
+			mActive.emplace_back(proxy);
+			if (isNew)
+			{
+				mActiveNewIndex[proxy] = static_cast<int>(mActiveNew.size());
+				mActiveNew.emplace_back(proxy);
+			}
+		}
+		else
+		{
+			// Swap it with the last one to remove it
+			int index = mActiveIndex[proxy];
+			mActive[index] = mActive.back();
+			mActiveIndex[mActive[index]] = index;
+			mActive.pop_back();
+			if (isNew)
+			{
+				index = mActiveNewIndex[proxy];
+				mActiveNew[index] = mActiveNew.back();
+				mActiveNewIndex[mActiveNew[index]] = index;
+				mActiveNew.pop_back();
+			}
+		}
+	}
+
+	for (const PendingProxy& pending : mPending)
+	{
+		mProxies[pending.mProxy].mPending = -1;
+	}
+	mPending.clear();
+}
+
+void SweepAndPrune::ApplyChanges()
+{
+	// (compact first, so the merge has fewer endpoints to move)
+	if (mHasDead)
+	{
+		Compact();
+	}
+	InsertPending();
+}
+
+void SweepAndPrune::RemovePending(int proxyID)
+{
+	int index = mProxies[proxyID].mPending;
+	mPending[index] = mPending.back();
+	mProxies[mPending[index].mProxy].mPending = index;
+	mPending.pop_back();
+	mProxies[proxyID].mPending = -1;
+}
+
+uint64_t SweepAndPrune::PairKey(int a, int b)
+{
+	uint64_t lo = static_cast<uint64_t>(Math::Min(a, b));
+	uint64_t hi = static_cast<uint64_t>(Math::Max(a, b));
+	return (lo << 32) | hi;
+}
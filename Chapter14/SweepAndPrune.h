@@ -0,0 +1,126 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+#include "Collision.h"
+
+// Persistent sweep and prune on all three axes. Each axis keeps a
+// sorted array of box endpoints, which is fixed up with insertion sort
+// when a box moves (so a box that barely moved costs almost nothing).
+// Swaps in the arrays are exactly where pairs start/stop overlapping,
+// so the set of overlapping pairs is kept up to date along the way.
+// New boxes are added to the arrays together (sorted and merged in
+// one pass) the next time the pairs are needed, rather than each one
+// sorting its way in from the end. Destroyed boxes are likewise only
+// marked, and all of them are removed in one pass at that point.
+class SweepAndPrune
+{
+public:
+	enum PairEvent
+	{
+		EBegin,
+		EPersist,
+		EEnd
+	};
+
+	SweepAndPrune();
+
+	// Returns the proxy ID for the box
+	int CreateProxy(const AABB& box, void* userData);
+	void DestroyProxy(int proxyID);
+	void UpdateProxy(int proxyID, const AABB& box);
+
+	void* GetUserData(int proxyID) const { return mProxies[proxyID].mUserData; }
+
+	// Calls f with each pair of overlapping boxes' user data
+	void ForEachPair(const std::function<void(void*, void*)>& f);
+	// Calls f with the pairs that began overlapping since the last call,
+	// the ones that still overlap, and the ones that stopped overlapping.
+	// (A pair with a destroyed box just goes away, with no end event.)
+	void ReportPairs(const std::function<void(PairEvent, void*, void*)>& f);
+
+	size_t GetNumPairs();
+	// Bytes used by the endpoint arrays, proxies, and pairs
+	size_t GetMemoryUsage() const;
+
+	static const int NullProxy = -1;
+private:
+	struct Endpoint
+	{
+		float mValue;
+		// Proxy ID << 1, with the low bit set for a max endpoint
+		uint32_t mData;
+
+		int GetProxy() const { return static_cast<int>(mData >> 1); }
+		bool IsMax() const { return (mData & 1) != 0; }
+	};
+
+	struct Proxy
+	{
+		// Index of this proxy's endpoints in each axis
+		uint32_t mMin[3];
+		uint32_t mMax[3];
+		void* mUserData;
+		// Index in mPending, or -1 once it's in the endpoint arrays
+		int mPending;
+		bool mAlive;
+	};
+
+	struct PendingProxy
+	{
+		int mProxy;
+		AABB mBox;
+	};
+
+	struct Pair
+	{
+		int mProxyA;
+		int mProxyB;
+		// Not reported yet (so it's a begin, not a persist)
+		bool mIsNew;
+	};
+
+	// Move an endpoint to its sorted spot
+	void SortDown(int axis, uint32_t index);
+	void SortUp(int axis, uint32_t index);
+	void SetEndpointIndex(const Endpoint& e, int axis, uint32_t index);
+	// Do the two overlap on the axes other than this one?
+	// (compares endpoint order, so it matches the sorted arrays)
+	bool OverlapsOtherAxes(int axis, int a, int b) const;
+	void AddPair(int a, int b);
+	void RemovePair(int a, int b);
+	// Remove dead proxies' endpoints and pairs
+	void Compact();
+	// Add the pending proxies to the arrays, and find their pairs
+	void InsertPending();
+	// Apply the destroys and creates since the pairs were last needed
+	void ApplyChanges();
+	void RemovePending(int proxyID);
+
+	static uint64_t PairKey(int a, int b);
+
+	std::vector<Endpoint> mAxes[3];
+	std::vector<Proxy> mProxies;
+	std::vector<int> mFreeProxies;
+	std::vector<PendingProxy> mPending;
+	// Boxes open at the current point of the sweep in InsertPending
+	// (all of them, and just the new ones), and where each one is in
+	// those lists
+	std::vector<int> mActive;
+	std::vector<int> mActiveNew;
+	std::vector<int> mActiveIndex;
+	std::vector<int> mActiveNewIndex;
+	std::unordered_map<uint64_t, Pair> mPairs;
+	// Pairs that stopped overlapping since the last report
+	std::vector<std::pair<int, int>> mEnded;
+	bool mHasDead;
+};
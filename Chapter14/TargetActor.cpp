@@ -11,6 +11,7 @@
 #include "Renderer.h"
 #include "MeshComponent.h"
 #include "BoxComponent.h"
+#include "PhysWorld.h"
 #include "Mesh.h"
 #include "TargetComponent.h"
 
@@ -25,5 +26,6 @@ TargetActor::TargetActor(Game* game)
 	// Add collision box
 	BoxComponent* bc = new BoxComponent(this);
 	bc->SetObjectBox(mesh->GetBox());
+	bc->SetLayer(PhysWorld::ELayerTarget);
 	new TargetComponent(this);
 }
@@ -18,10 +18,10 @@
 TargetComponent::TargetComponent(Actor * owner)
 	:Component(owner)
 {
-	mOwner->GetGame()->GetHUD()->AddTargetComponent(this);
+	mHUDHandle = mOwner->GetGame()->GetHUD()->AddTargetComponent(this);
 }
 
 TargetComponent::~TargetComponent()
 {
-	mOwner->GetGame()->GetHUD()->RemoveTargetComponent(this);
+	mOwner->GetGame()->GetHUD()->RemoveTargetComponent(mHUDHandle);
 }
@@ -8,6 +8,7 @@
 
 #pragma once
 #include "Component.h"
+#include "SlotMap.h"
 
 class TargetComponent : public Component
 {
@@ -15,4 +16,7 @@ public:
 	TargetComponent(class Actor* owner);
 	~TargetComponent();
 	TypeID GetType() const override { return TTargetComponent; }
+private:
+	// Handle in the HUD's targets
+	SlotHandle mHUDHandle;
 };
@@ -71,9 +71,31 @@ bool Texture::Load(const std::string& fileName)
 	return true;
 }
 
+bool Texture::LoadHeadless(const std::string& fileName)
+{
+	mFileName = fileName;
+	int channels = 0;
+
+	unsigned char* image = SOIL_load_image(fileName.c_str(),
+										   &mWidth, &mHeight, &channels, SOIL_LOAD_AUTO);
+
+	if (image == nullptr)
+	{
+		SDL_Log("SOIL failed to load image %s: %s", fileName.c_str(), SOIL_last_result());
+		return false;
+	}
+
+	SOIL_free_image_data(image);
+	return true;
+}
+
 void Texture::Unload()
 {
-	glDeleteTextures(1, &mTextureID);
+	// Headless textures never made a GL texture
+	if (mTextureID != 0)
+	{
+		glDeleteTextures(1, &mTextureID);
+	}
 }
 
 void Texture::CreateFromSurface(SDL_Surface* surface)
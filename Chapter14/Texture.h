@@ -15,6 +15,9 @@ public:
 	~Texture();
 	
 	bool Load(const std::string& fileName);
+	// Only reads the image size, without creating a GL texture
+	// (for headless runs, which have no GL context)
+	bool LoadHeadless(const std::string& fileName);
 	void Unload();
 	void CreateFromSurface(struct SDL_Surface* surface);
 	void CreateForRendering(int width, int height, unsigned int format);
@@ -0,0 +1,256 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#include "TransformSystem.h"
+#include "Game.h"
+#include "Actor.h"
+#include "JobSystem.h"
+#include "CommandBuffer.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace
+{
+	// Move the last element into index, and drop the last element
+	template <typename T>
+	void SwapPop(std::vector<T>& vec, size_t index)
+	{
+		vec[index] = vec.back();
+		vec.pop_back();
+	}
+}
+
+TransformSystem::TransformSystem(Game* game)
+	:mGame(game)
+	,mHierarchyDirty(false)
+{
+}
+
+TransformSystem::~TransformSystem()
+{
+}
+
+size_t TransformSystem::AddTransform(Actor* actor)
+{
+	mOwners.emplace_back(actor);
+	mPositions.emplace_back(Vector3::Zero);
+	mRotations.emplace_back(Quaternion::Identity);
+	mScales.emplace_back(1.0f);
+	mWorld.emplace_back(Matrix4::Identity);
+	mDirty.emplace_back(1);
+	mChanged.emplace_back(0);
+	mHasParent.emplace_back(0);
+	mPrevPositions.emplace_back(Vector3::Zero);
+	mPrevRotations.emplace_back(Quaternion::Identity);
+	mPrevScales.emplace_back(1.0f);
+	mHasPrev.emplace_back(0);
+	mRender.emplace_back(Matrix4::Identity);
+	return mOwners.size() - 1;
+}
+
+void TransformSystem::RemoveTransform(size_t index)
+{
+	if (mHasParent[index])
+	{
+		mHierarchyDirty = true;
+	}
+
+	SwapPop(mOwners, index);
+	SwapPop(mPositions, index);
+	SwapPop(mRotations, index);
+	SwapPop(mScales, index);
+	SwapPop(mWorld, index);
+	SwapPop(mDirty, index);
+	SwapPop(mChanged, index);
+	SwapPop(mHasParent, index);
+	SwapPop(mPrevPositions, index);
+	SwapPop(mPrevRotations, index);
+	SwapPop(mPrevScales, index);
+	SwapPop(mHasPrev, index);
+	SwapPop(mRender, index);
+
+	// The last actor's transform moved into this slot
+	if (index < mOwners.size())
+	{
+		mOwners[index]->SetTransformIndex(index);
+	}
+}
+
+void TransformSystem::SetHasParent(size_t index, bool hasParent)
+{
+	mHasParent[index] = hasParent ? 1 : 0;
+	mDirty[index] = 1;
+	mHierarchyDirty = true;
+}
+
+void TransformSystem::ComputeWorldTransform(size_t index)
+{
+	mWorld[index] = Matrix4::CreateFromTRS(mPositions[index],
+		mRotations[index], mScales[index]);
+	Actor* parent = mOwners[index]->GetParent();
+	if (parent)
+	{
+		mWorld[index] *= mWorld[parent->GetTransformIndex()];
+	}
+	mDirty[index] = 0;
+}
+
+void TransformSystem::Update()
+{
+	PROFILE_SCOPE("TransformSystem::Update");
+	if (mHierarchyDirty)
+	{
+		SortChildren();
+	}
+
+	JobSystem* jobs = mGame->GetJobSystem();
+	// Actors without a parent don't depend on each other,
+	// so these are split over the job system
+	jobs->ParallelFor(mOwners.size(), 512,
+		[this](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				mChanged[i] = 0;
+				if (mDirty[i] && !mHasParent[i])
+				{
+					mWorld[i] = Matrix4::CreateFromTRS(mPositions[i],
+						mRotations[i], mScales[i]);
+					mDirty[i] = 0;
+					mChanged[i] = 1;
+				}
+			}
+	});
+
+	// Children go in depth order, so the parent is always done first.
+	// A child is recomputed if it or its parent changed.
+	for (Actor* child : mChildren)
+	{
+		size_t i = child->GetTransformIndex();
+		size_t parent = child->GetParent()->GetTransformIndex();
+		if (mDirty[i] || mChanged[parent])
+		{
+			mWorld[i] = Matrix4::CreateFromTRS(mPositions[i],
+				mRotations[i], mScales[i]) * mWorld[parent];
+			mDirty[i] = 0;
+			mChanged[i] = 1;
+		}
+	}
+
+	// Inform components of the actors that changed
+	jobs->ParallelFor(mOwners.size(), 256,
+		[this](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				if (mChanged[i])
+				{
+					CommandBuffer::SetSortKey(i);
+					mOwners[i]->OnUpdateWorldTransform();
+				}
+			}
+	});
+}
+
+void TransformSystem::StorePrevTransforms()
+{
+	// Assignment reuses the existing storage
+	mPrevPositions = mPositions;
+	mPrevRotations = mRotations;
+	mPrevScales = mScales;
+	std::fill(mHasPrev.begin(), mHasPrev.end(), 1);
+}
+
+void TransformSystem::ComputeRenderTransforms(float alpha)
+{
+	PROFILE_SCOPE("TransformSystem::ComputeRenderTransforms");
+	if (mHierarchyDirty)
+	{
+		SortChildren();
+	}
+
+	mGame->GetJobSystem()->ParallelFor(mOwners.size(), 512,
+		[this, alpha](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				if (mHasParent[i])
+				{
+					continue;
+				}
+				bool moved = mHasPrev[i] && (mPrevScales[i] != mScales[i] ||
+					mPrevPositions[i].x != mPositions[i].x ||
+					mPrevPositions[i].y != mPositions[i].y ||
+					mPrevPositions[i].z != mPositions[i].z ||
+					mPrevRotations[i].x != mRotations[i].x ||
+					mPrevRotations[i].y != mRotations[i].y ||
+					mPrevRotations[i].z != mRotations[i].z ||
+					mPrevRotations[i].w != mRotations[i].w);
+				if (moved || mDirty[i])
+				{
+					mRender[i] = ComputeBlended(i, alpha);
+				}
+				else
+				{
+					// Nothing moved this tick
+					mRender[i] = mWorld[i];
+				}
+			}
+	});
+
+	// Children blend their local transform, on top of the parent's
+	// (already blended) render transform
+	for (Actor* child : mChildren)
+	{
+		size_t i = child->GetTransformIndex();
+		size_t parent = child->GetParent()->GetTransformIndex();
+		mRender[i] = ComputeBlended(i, alpha) * mRender[parent];
+	}
+}
+
+Matrix4 TransformSystem::ComputeBlended(size_t index, float alpha) const
+{
+	if (!mHasPrev[index])
+	{
+		// Nothing to blend from
+		return Matrix4::CreateFromTRS(mPositions[index],
+			mRotations[index], mScales[index]);
+	}
+
+	Vector3 pos = Vector3::Lerp(mPrevPositions[index], mPositions[index], alpha);
+	Quaternion rot = Quaternion::Slerp(mPrevRotations[index], mRotations[index], alpha);
+	float scale = Math::Lerp(mPrevScales[index], mScales[index], alpha);
+	return Matrix4::CreateFromTRS(pos, rot, scale);
+}
+
+void TransformSystem::SortChildren()
+{
+	mHierarchyDirty = false;
+
+	// Gather every actor with a parent, along with its depth
+	std::vector<std::pair<int, Actor*>> byDepth;
+	for (size_t i = 0; i < mOwners.size(); i++)
+	{
+		if (mHasParent[i])
+		{
+			int depth = 0;
+			for (Actor* a = mOwners[i]->GetParent(); a; a = a->GetParent())
+			{
+				depth++;
+			}
+			byDepth.emplace_back(depth, mOwners[i]);
+		}
+	}
+	std::stable_sort(byDepth.begin(), byDepth.end(),
+		[](const std::pair<int, Actor*>& a, const std::pair<int, Actor*>& b) {
+			return a.first < b.first;
+	});
+
+	mChildren.clear();
+	for (auto& d : byDepth)
+	{
+		mChildren.emplace_back(d.second);
+	}
+}
@@ -0,0 +1,90 @@
+// ----------------------------------------------------------------
+// From Game Programming in C++ by Sanjay Madhav
+// Copyright (C) 2017 Sanjay Madhav. All rights reserved.
+// 
+// Released under the BSD License
+// See LICENSE in root directory for full details.
+// ----------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Math.h"
+
+// Owns every actor's position, rotation, and scale, stored as
+// parallel arrays (one entry per actor) so the world matrices can be
+// rebuilt in one pass instead of actor by actor.
+// Position/rotation/scale are relative to the actor's parent, if it
+// has one; world matrices include the parent's transform.
+class TransformSystem
+{
+public:
+	TransformSystem(class Game* game);
+	~TransformSystem();
+
+	// Add/remove an actor's transform (called by Actor).
+	// Returns the actor's index, which can change on a removal.
+	size_t AddTransform(class Actor* actor);
+	void RemoveTransform(size_t index);
+
+	// Local transform
+	const Vector3& GetPosition(size_t index) const { return mPositions[index]; }
+	void SetPosition(size_t index, const Vector3& pos) { mPositions[index] = pos; mDirty[index] = 1; }
+	const Quaternion& GetRotation(size_t index) const { return mRotations[index]; }
+	void SetRotation(size_t index, const Quaternion& rot) { mRotations[index] = rot; mDirty[index] = 1; }
+	float GetScale(size_t index) const { return mScales[index]; }
+	void SetScale(size_t index, float scale) { mScales[index] = scale; mDirty[index] = 1; }
+	bool GetIsDirty(size_t index) const { return mDirty[index] != 0; }
+
+	const Matrix4& GetWorldTransform(size_t index) const { return mWorld[index]; }
+	const Matrix4& GetRenderTransform(size_t index) const { return mRender[index]; }
+
+	// Recompute one actor's world transform right away (its parent's
+	// world transform must already be up to date)
+	void ComputeWorldTransform(size_t index);
+
+	// Rebuild the world transform of everything that's dirty (or has
+	// a dirty ancestor), then let their components know
+	void Update();
+
+	// Snapshot every transform at the start of a simulation tick
+	void StorePrevTransforms();
+	// Blend every transform between the previous and current tick
+	void ComputeRenderTransforms(float alpha);
+
+	// Parenting changed (called by Actor::SetParent)
+	void SetHasParent(size_t index, bool hasParent);
+	size_t GetNumTransforms() const { return mOwners.size(); }
+private:
+	// Sort the actors that have a parent by depth, so a parent's
+	// world transform is always computed before its children's
+	void SortChildren();
+	// Local transform blended between the previous and current tick
+	Matrix4 ComputeBlended(size_t index, float alpha) const;
+
+	class Game* mGame;
+
+	// One entry per actor (swap-and-pop on removal)
+	std::vector<class Actor*> mOwners;
+	std::vector<Vector3> mPositions;
+	std::vector<Quaternion> mRotations;
+	std::vector<float> mScales;
+	std::vector<Matrix4> mWorld;
+	// Set when the local transform changes (bytes, not vector<bool>,
+	// so different job threads can set neighbouring entries)
+	std::vector<uint8_t> mDirty;
+	// Set by Update for entries whose world transform changed
+	std::vector<uint8_t> mChanged;
+	std::vector<uint8_t> mHasParent;
+
+	// Transform as of the previous tick (for interpolation)
+	std::vector<Vector3> mPrevPositions;
+	std::vector<Quaternion> mPrevRotations;
+	std::vector<float> mPrevScales;
+	std::vector<uint8_t> mHasPrev;
+	std::vector<Matrix4> mRender;
+
+	// Actors with a parent, sorted by depth
+	std::vector<class Actor*> mChildren;
+	bool mHierarchyDirty;
+};
@@ -8,7 +8,7 @@
 
 #include "UIScreen.h"
 #include "Texture.h"
-#include "Shader.h"
+#include "SpriteBatch.h"
 #include "Game.h"
 #include "Renderer.h"
 #include "Font.h"
@@ -49,26 +49,26 @@ void UIScreen::Update(float deltaTime)
 	
 }
 
-void UIScreen::Draw(Shader* shader)
+void UIScreen::Draw(SpriteBatch* batch)
 {
 	// Draw background (if exists)
 	if (mBackground)
 	{
-		DrawTexture(shader, mBackground, mBGPos);
+		DrawTexture(batch, mBackground, mBGPos);
 	}
 	// Draw title (if exists)
 	if (mTitle)
 	{
-		DrawTexture(shader, mTitle, mTitlePos);
+		DrawTexture(batch, mTitle, mTitlePos);
 	}
 	// Draw buttons
 	for (auto b : mButtons)
 	{
 		// Draw background of button
 		Texture* tex = b->GetHighlighted() ? mButtonOn : mButtonOff;
-		DrawTexture(shader, tex, b->GetPosition());
+		DrawTexture(batch, tex, b->GetPosition());
 		// Draw text of button
-		DrawTexture(shader, b->GetNameTex(), b->GetPosition());
+		DrawTexture(batch, b->GetNameTex(), b->GetPosition());
 	}
 	// Override in subclasses to draw any textures
 }
@@ -154,7 +154,7 @@ void UIScreen::AddButton(const std::string& name, std::function<void()> onClick)
 	mNextButtonPos.y -= mButtonOff->GetHeight() + 20.0f;
 }
 
-void UIScreen::DrawTexture(class Shader* shader, class Texture* texture,
+void UIScreen::DrawTexture(class SpriteBatch* batch, class Texture* texture,
 				 const Vector2& offset, float scale, bool flipY)
 {
 	// Scale the quad by the width/height of texture
@@ -171,13 +171,9 @@ void UIScreen::DrawTexture(class Shader* shader, class Texture* texture,
 	Matrix4 transMat = Matrix4::CreateTranslation(
 		Vector3(offset.x, offset.y, 0.0f));
 
-	// Set world transform
+	// Add the quad to the batch
 	Matrix4 world = scaleMat * transMat;
-	shader->SetMatrixUniform("uWorldTransform", world);
-	// Set current texture
-	texture->SetActive();
-	// Draw quad
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+	batch->Draw(texture, world);
 }
 
 void UIScreen::SetRelativeMouseMode(bool relative)
@@ -51,7 +51,7 @@ public:
 	virtual ~UIScreen();
 	// UIScreen subclasses can override these
 	virtual void Update(float deltaTime);
-	virtual void Draw(class Shader* shader);
+	virtual void Draw(class SpriteBatch* batch);
 	virtual void ProcessInput(const uint8_t* keys);
 	virtual void HandleKeyPress(int key);
 	// Tracks if the UI is active or closing
@@ -72,7 +72,7 @@ public:
 	void AddButton(const std::string& name, std::function<void()> onClick);
 protected:
 	// Helper to draw a texture
-	void DrawTexture(class Shader* shader, class Texture* texture,
+	void DrawTexture(class SpriteBatch* batch, class Texture* texture,
 					 const Vector2& offset = Vector2::Zero,
 					 float scale = 1.0f,
 					 bool flipY = false);
@@ -9,6 +9,12 @@
 #include "VertexArray.h"
 #include <GL/glew.h>
 
+namespace
+{
+	// After the vertex attributes of the (non-skinned) layout
+	const GLuint FirstInstanceAttrib = 3;
+}
+
 VertexArray::VertexArray(const void* verts, unsigned int numVerts, Layout layout,
 	const unsigned int* indices, unsigned int numIndices)
 	:mNumVerts(numVerts)
@@ -81,6 +87,28 @@ void VertexArray::SetActive()
 	glBindVertexArray(mVertexArray);
 }
 
+void VertexArray::SetInstanceBuffer(unsigned int buffer, size_t offset)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	for (GLuint row = 0; row < 4; row++)
+	{
+		GLuint attrib = FirstInstanceAttrib + row;
+		glEnableVertexAttribArray(attrib);
+		glVertexAttribPointer(attrib, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 16,
+			reinterpret_cast<void*>(offset + sizeof(float) * 4 * row));
+		// Advance once per instance, not per vertex
+		glVertexAttribDivisor(attrib, 1);
+	}
+}
+
+void VertexArray::ClearInstanceBuffer()
+{
+	for (GLuint row = 0; row < 4; row++)
+	{
+		glDisableVertexAttribArray(FirstInstanceAttrib + row);
+	}
+}
+
 unsigned int VertexArray::GetVertexSize(VertexArray::Layout layout)
 {
 	unsigned vertexSize = 8 * sizeof(float);
@@ -7,6 +7,8 @@
 // ----------------------------------------------------------------
 
 #pragma once
+#include <cstddef>
+
 class VertexArray
 {
 public:
@@ -22,8 +24,13 @@ public:
 	~VertexArray();
 
 	void SetActive();
+	// Read a world transform per instance (attributes 3-6, one for each
+	// row) from buffer, starting offset bytes in. Must be active first.
+	void SetInstanceBuffer(unsigned int buffer, size_t offset);
+	void ClearInstanceBuffer();
 	unsigned int GetNumIndices() const { return mNumIndices; }
 	unsigned int GetNumVerts() const { return mNumVerts; }
+	unsigned int GetID() const { return mVertexArray; }
 
 	static unsigned int GetVertexSize(VertexArray::Layout layout);
 private: